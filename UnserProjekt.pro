@@ -15,11 +15,13 @@ LIBS += -L/home/vmuser/qtprojects/UnserProjekt -lsrf02
 
 SOURCES += main.cpp\
         mainwindow.cpp \
-    qcustomplot.cpp
+    qcustomplot.cpp \
+    filterpipeline.cpp
 
 HEADERS  += mainwindow.h \
     qcustomplot.h \
-    srf02.h
+    srf02.h \
+    filterpipeline.h
 
 FORMS    += mainwindow.ui
 
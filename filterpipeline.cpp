@@ -0,0 +1,205 @@
+/**
+ * @file filterpipeline.cpp
+ *
+ */
+
+#include "filterpipeline.h"
+#include <QtCore/qmath.h>
+#include <QtCore/qnumeric.h>
+
+/**
+ * @brief
+ * Reserviert den Speicher fuer capacity Werte
+ * @param capacity
+ */
+RingBuffer::RingBuffer(int capacity) : mData(qMax(1, capacity)), mNext(0), mSize(0){
+}
+
+double RingBuffer::push(double value){
+    double oldest = mData.at(mNext);
+    mData[mNext] = value;
+    mNext = (mNext+1) % mData.size();
+    if(mSize < mData.size())
+        ++mSize;
+    return oldest;
+}
+
+void RingBuffer::clear(){
+    mNext = 0;
+    mSize = 0;
+}
+
+/**
+ * @brief
+ * Das sortierte Fenster wird wie der Ringpuffer nur einmal angelegt
+ * @param windowSize
+ */
+MedianFilter::MedianFilter(int windowSize) : mWindow(windowSize), mSorted(mWindow.capacity()), mSortedSize(0){
+}
+
+/**
+ * @brief
+ * Haelt eine sortierte Kopie des Fensters. Pro Wert wird der aelteste Wert entfernt
+ * und der neue einsortiert, das kostet bei festem N konstante Zeit und keine Allokation.
+ * NaN wird nicht ins Fenster aufgenommen, da es im sortierten Fenster nicht wiedergefunden
+ * werden kann. Stattdessen wird der bisherige Median zurueckgegeben.
+ * @param value
+ * @return double
+ */
+double MedianFilter::process(double value){
+    if(qIsNaN(value))
+        return mSortedSize > 0 ? mSorted.at(mSortedSize/2) : value;
+    bool wasFull = mWindow.isFull();
+    double oldest = mWindow.push(value);
+    if(wasFull){
+        // Aeltesten Wert aus dem sortierten Fenster entfernen
+        int i = 0;
+        while(i < mSortedSize-1 && mSorted.at(i) != oldest)
+            ++i;
+        for(; i < mSortedSize-1; ++i)
+            mSorted[i] = mSorted.at(i+1);
+        --mSortedSize;
+    }
+    // Neuen Wert einsortieren
+    int i = mSortedSize;
+    while(i > 0 && mSorted.at(i-1) > value){
+        mSorted[i] = mSorted.at(i-1);
+        --i;
+    }
+    mSorted[i] = value;
+    ++mSortedSize;
+    return mSorted.at(mSortedSize/2);
+}
+
+void MedianFilter::reset(){
+    mWindow.clear();
+    mSortedSize = 0;
+}
+
+MovingAverageFilter::MovingAverageFilter(int windowSize) : mWindow(windowSize), mSum(0){
+}
+
+/**
+ * @brief
+ * Laufende Summe: neuer Wert dazu, verdraengter Wert weg
+ * @param value
+ * @return double
+ */
+double MovingAverageFilter::process(double value){
+    bool wasFull = mWindow.isFull();
+    double oldest = mWindow.push(value);
+    mSum += value;
+    if(wasFull)
+        mSum -= oldest;
+    return mSum/mWindow.size();
+}
+
+void MovingAverageFilter::reset(){
+    mWindow.clear();
+    mSum = 0;
+}
+
+/**
+ * @brief
+ *
+ * @param alpha Gewicht des neuen Werts zwischen 0 und 1
+ */
+EmaFilter::EmaFilter(double alpha) : mAlpha(qBound(0.0, alpha, 1.0)), mValue(0), mInitialized(false){
+}
+
+double EmaFilter::process(double value){
+    // Erster Wert startet den Mittelwert, sonst wuerde er von 0 aus anlaufen
+    if(!mInitialized){
+        mValue = value;
+        mInitialized = true;
+    } else
+        mValue += mAlpha*(value-mValue);
+    return mValue;
+}
+
+void EmaFilter::reset(){
+    mInitialized = false;
+}
+
+/**
+ * @brief
+ *
+ * @param windowSize Anzahl der Werte fuer Mittelwert und Standardabweichung
+ * @param threshold Anzahl Standardabweichungen ab der ein Wert markiert wird
+ * @param minDeviation Abweichung die mindestens noetig ist, damit ein Wert markiert wird
+ */
+OutlierFlagger::OutlierFlagger(int windowSize, double threshold, double minDeviation) : mWindow(windowSize), mThreshold(threshold), mMinDeviation(minDeviation), mSum(0), mSquareSum(0), mFlagged(false){
+}
+
+/**
+ * @brief
+ * Vergleicht den Wert mit Mittelwert und Standardabweichung der vorherigen Werte,
+ * beide werden ueber laufende Summen in konstanter Zeit berechnet
+ * @param value
+ * @return double
+ */
+double OutlierFlagger::process(double value){
+    mFlagged = false;
+    int n = mWindow.size();
+    // Erst ab ein paar Werten ist die Standardabweichung aussagekraeftig
+    if(n >= 3){
+        double mean = mSum/n;
+        double variance = qMax(0.0, mSquareSum/n - mean*mean);
+        // Der Sensor liefert ganze cm, bei ruhendem Ziel ist die Varianz 0 und
+        // sonst wuerde jede Aenderung um 1 cm markiert
+        mFlagged = qAbs(value-mean) > qMax(mMinDeviation, mThreshold*qSqrt(variance));
+    }
+    bool wasFull = mWindow.isFull();
+    double oldest = mWindow.push(value);
+    mSum += value;
+    mSquareSum += value*value;
+    if(wasFull){
+        mSum -= oldest;
+        mSquareSum -= oldest*oldest;
+    }
+    return value;
+}
+
+void OutlierFlagger::reset(){
+    mWindow.clear();
+    mSum = 0;
+    mSquareSum = 0;
+    mFlagged = false;
+}
+
+FilterPipeline::FilterPipeline() : mFlagged(false){
+}
+
+/**
+ * @brief
+ * Dekonstruktor -- Stufen loeschen
+ */
+FilterPipeline::~FilterPipeline(){
+    qDeleteAll(mStages);
+}
+
+void FilterPipeline::addStage(FilterStage *stage){
+    if(stage)
+        mStages.append(stage);
+}
+
+/**
+ * @brief
+ * Schickt den Wert der Reihe nach durch alle Stufen
+ * @param value
+ * @return double
+ */
+double FilterPipeline::process(double value){
+    mFlagged = false;
+    for(int i = 0; i < mStages.size(); i++){
+        value = mStages.at(i)->process(value);
+        mFlagged = mFlagged || mStages.at(i)->flagged();
+    }
+    return value;
+}
+
+void FilterPipeline::reset(){
+    for(int i = 0; i < mStages.size(); i++)
+        mStages.at(i)->reset();
+    mFlagged = false;
+}
@@ -0,0 +1,287 @@
+/**
+ * @file filterpipeline.h
+ *
+ */
+
+#ifndef FILTERPIPELINE_H
+#define FILTERPIPELINE_H
+
+#include <QVector>
+
+/**
+ * @brief
+ * Ringpuffer fester Groesse. Der Speicher wird im Konstruktor einmal reserviert,
+ * danach wird beim Einfuegen nichts mehr alloziert.
+ */
+class RingBuffer
+{
+public:
+    /**
+     * @brief
+     *
+     * @param capacity
+     */
+    explicit RingBuffer(int capacity);
+
+    /**
+     * @brief
+     * Fuegt einen Wert hinzu und gibt den verdraengten aeltesten Wert zurueck
+     * (nur gueltig wenn der Puffer vorher voll war)
+     * @param value
+     * @return double
+     */
+    double push(double value);
+    /**
+     * @brief
+     *
+     */
+    void clear();
+    /**
+     * @brief
+     *
+     * @return int
+     */
+    int size() const { return mSize; }
+    /**
+     * @brief
+     *
+     * @return int
+     */
+    int capacity() const { return mData.size(); }
+    /**
+     * @brief
+     *
+     * @return bool
+     */
+    bool isFull() const { return mSize == mData.size(); }
+
+private:
+    QVector<double> mData; /**< TODO: describe */
+    int mNext; /**< TODO: describe */
+    int mSize; /**< TODO: describe */
+};
+
+/**
+ * @brief
+ * Basisklasse fuer eine Stufe der Filterkette
+ */
+class FilterStage
+{
+public:
+    /**
+     * @brief
+     *
+     */
+    virtual ~FilterStage() {}
+    /**
+     * @brief
+     * Verarbeitet einen Messwert und gibt den gefilterten Wert zurueck
+     * @param value
+     * @return double
+     */
+    virtual double process(double value) = 0;
+    /**
+     * @brief
+     *
+     */
+    virtual void reset() = 0;
+    /**
+     * @brief
+     * Gibt an ob der letzte Messwert als Ausreisser markiert wurde
+     * @return bool
+     */
+    virtual bool flagged() const { return false; }
+};
+
+/**
+ * @brief
+ * Gleitender Median ueber N Werte, entfernt einzelne Spitzen
+ */
+class MedianFilter : public FilterStage
+{
+public:
+    /**
+     * @brief
+     *
+     * @param windowSize
+     */
+    explicit MedianFilter(int windowSize);
+    /**
+     * @brief
+     *
+     * @param value
+     * @return double
+     */
+    double process(double value);
+    /**
+     * @brief
+     *
+     */
+    void reset();
+
+private:
+    RingBuffer mWindow; /**< TODO: describe */
+    QVector<double> mSorted; /**< TODO: describe */
+    int mSortedSize; /**< TODO: describe */
+};
+
+/**
+ * @brief
+ * Gleitender Mittelwert ueber N Werte
+ */
+class MovingAverageFilter : public FilterStage
+{
+public:
+    /**
+     * @brief
+     *
+     * @param windowSize
+     */
+    explicit MovingAverageFilter(int windowSize);
+    /**
+     * @brief
+     *
+     * @param value
+     * @return double
+     */
+    double process(double value);
+    /**
+     * @brief
+     *
+     */
+    void reset();
+
+private:
+    RingBuffer mWindow; /**< TODO: describe */
+    double mSum; /**< TODO: describe */
+};
+
+/**
+ * @brief
+ * Exponentiell gleitender Mittelwert
+ */
+class EmaFilter : public FilterStage
+{
+public:
+    /**
+     * @brief
+     *
+     * @param alpha
+     */
+    explicit EmaFilter(double alpha);
+    /**
+     * @brief
+     *
+     * @param value
+     * @return double
+     */
+    double process(double value);
+    /**
+     * @brief
+     *
+     */
+    void reset();
+
+private:
+    double mAlpha; /**< TODO: describe */
+    double mValue; /**< TODO: describe */
+    bool mInitialized; /**< TODO: describe */
+};
+
+/**
+ * @brief
+ * Markiert Werte die mehr als k Standardabweichungen, mindestens aber die
+ * Mindestabweichung, vom gleitenden Mittelwert abweichen. Der Wert selbst wird
+ * unveraendert weitergegeben.
+ */
+class OutlierFlagger : public FilterStage
+{
+public:
+    /**
+     * @brief
+     *
+     * @param windowSize
+     * @param threshold
+     * @param minDeviation
+     */
+    OutlierFlagger(int windowSize, double threshold, double minDeviation = 5);
+    /**
+     * @brief
+     *
+     * @param value
+     * @return double
+     */
+    double process(double value);
+    /**
+     * @brief
+     *
+     */
+    void reset();
+    /**
+     * @brief
+     *
+     * @return bool
+     */
+    bool flagged() const { return mFlagged; }
+
+private:
+    RingBuffer mWindow; /**< TODO: describe */
+    double mThreshold; /**< TODO: describe */
+    double mMinDeviation; /**< TODO: describe */
+    double mSum; /**< TODO: describe */
+    double mSquareSum; /**< TODO: describe */
+    bool mFlagged; /**< TODO: describe */
+};
+
+/**
+ * @brief
+ * Kette von Filterstufen zwischen Sensor und Graph. Die Stufen werden in der
+ * Reihenfolge durchlaufen in der sie hinzugefuegt wurden.
+ */
+class FilterPipeline
+{
+public:
+    /**
+     * @brief
+     *
+     */
+    FilterPipeline();
+    /**
+     * @brief
+     *
+     */
+    ~FilterPipeline();
+
+    /**
+     * @brief
+     * Fuegt eine Stufe hinzu, die Pipeline uebernimmt den Besitz
+     * @param stage
+     */
+    void addStage(FilterStage *stage);
+    /**
+     * @brief
+     *
+     * @param value
+     * @return double
+     */
+    double process(double value);
+    /**
+     * @brief
+     *
+     */
+    void reset();
+    /**
+     * @brief
+     * Gibt an ob eine Stufe den letzten Messwert als Ausreisser markiert hat
+     * @return bool
+     */
+    bool flagged() const { return mFlagged; }
+
+private:
+    QVector<FilterStage*> mStages; /**< TODO: describe */
+    bool mFlagged; /**< TODO: describe */
+
+    Q_DISABLE_COPY(FilterPipeline)
+};
+
+#endif // FILTERPIPELINE_H
@@ -33,11 +33,20 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
     ui->widget->graph(0)->setPen(QPen(Qt::blue));
     ui->widget->graph(0)->setBrush(QBrush(QColor(240, 255, 200)));
     ui->widget->graph(0)->setAntialiasedFill(false);
+    // Gefilterte Werte
+    ui->widget->addGraph();
+    ui->widget->graph(1)->setPen(QPen(Qt::red));
+    // Als Ausreisser markierte Rohwerte nur als Punkte
+    ui->widget->addGraph();
+    ui->widget->graph(2)->setLineStyle(QCPGraph::lsNone);
+    ui->widget->graph(2)->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, Qt::black, 6));
     ui->widget->xAxis->setTickLabelType(QCPAxis::ltDateTime);
     ui->widget->xAxis->setDateTimeFormat("mm:ss");
     ui->widget->xAxis->setAutoTickStep(true);
     ui->widget->xAxis->setTickStep(5);
     ui->widget->axisRect()->setupFullAxesBox();
+    // Raender erst nach 5 Messungen verkleinern, damit der Graph nicht springt
+    ui->widget->axisRect()->setAutoMarginShrinkDelay(5);
     ui->widget->yAxis->setRange(0,600);
     ui->widget->graph(0)->rescaleAxes();
 
@@ -45,6 +54,11 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
     connect(ui->widget->xAxis, SIGNAL(rangeChanged(QCPRange)), ui->widget->xAxis2, SLOT(setRange(QCPRange)));
     connect(ui->widget->yAxis, SIGNAL(rangeChanged(QCPRange)), ui->widget->yAxis2, SLOT(setRange(QCPRange)));
 
+    // Filterkette: Ausreisser markieren, Spitzen per Median entfernen, dann glaetten
+    filter.addStage(new OutlierFlagger(20, 3));
+    filter.addStage(new MedianFilter(5));
+    filter.addStage(new EmaFilter(0.3));
+
     // Initialisieren I2C
     fd = initi2c();
 
@@ -108,7 +122,11 @@ void MainWindow::update(){
     // Berechnung nach datenblatt. 255*Erstes Register + Zweites Register
     int distance = 255*readByte(fd, 0x02)+readByte(fd, 0x03);
     // Hinzufügen der Daten zum Graph
-    ui->widget->graph(0)->addData(datenCounter++, distance);
+    ui->widget->graph(0)->addData(datenCounter, distance);
+    ui->widget->graph(1)->addData(datenCounter, filter.process(distance));
+    if(filter.flagged())
+        ui->widget->graph(2)->addData(datenCounter, distance);
+    datenCounter++;
     // Achsen neu skalieren
     ui->widget->graph(0)->rescaleAxes();
     // Wert im LCD Display anzeigen
@@ -129,6 +147,9 @@ void MainWindow::on_pushButton_clicked()
     QVector<double> x(0), y(0);
     // Leeren Vektor als Daten für Graphen setzen -> Er wird leer
     ui->widget->graph(0)->setData(x, y);
+    ui->widget->graph(1)->setData(x, y);
+    ui->widget->graph(2)->setData(x, y);
+    filter.reset();
     // X Achsen counter resetten
     datenCounter = 0;
     // Achsen neu skalieren
@@ -12,6 +12,7 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include "filterpipeline.h"
 
 namespace Ui {
 class MainWindow;
@@ -59,6 +60,7 @@ private slots:
 private:
     Ui::MainWindow *ui; /**< TODO: describe */
     QWidget* x; /**< TODO: describe */
+    FilterPipeline filter; /**< Filterkette zwischen Sensor und Graph */
 };
 
 #endif // MAINWINDOW_H
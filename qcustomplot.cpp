@@ -144,6 +144,26 @@ void QCPPainter::drawLine(const QLineF &line)
     QPainter::drawLine(line.toLine());
 }
 
+/*! \overload
+  
+  Draws all \a lines with one call to the paint engine. Like \ref drawLine, rounds the lines to
+  integer coordinates when antialiasing is disabled.
+  
+  \note this function hides the non-virtual base class implementation.
+*/
+void QCPPainter::drawLines(const QVector<QLineF> &lines)
+{
+  if (mIsAntialiasing || mModes.testFlag(pmVectorized))
+    QPainter::drawLines(lines);
+  else
+  {
+    QVector<QLine> roundedLines(lines.size());
+    for (int i=0; i<lines.size(); ++i)
+      roundedLines[i] = lines.at(i).toLine();
+    QPainter::drawLines(roundedLines);
+  }
+}
+
 /*!
   Sets whether painting uses antialiasing or not. Use this method instead of using setRenderHint
   with QPainter::Antialiasing directly, as it allows QCPPainter to regain pixel exactness between
@@ -343,7 +363,8 @@ QCPScatterStyle::QCPScatterStyle() :
   mShape(ssNone),
   mPen(Qt::NoPen),
   mBrush(Qt::NoBrush),
-  mPenDefined(false)
+  mPenDefined(false),
+  mSpriteAntialiased(false)
 {
 }
 
@@ -359,7 +380,8 @@ QCPScatterStyle::QCPScatterStyle(ScatterShape shape, double size) :
   mShape(shape),
   mPen(Qt::NoPen),
   mBrush(Qt::NoBrush),
-  mPenDefined(false)
+  mPenDefined(false),
+  mSpriteAntialiased(false)
 {
 }
 
@@ -372,7 +394,8 @@ QCPScatterStyle::QCPScatterStyle(ScatterShape shape, const QColor &color, double
   mShape(shape),
   mPen(QPen(color)),
   mBrush(Qt::NoBrush),
-  mPenDefined(true)
+  mPenDefined(true),
+  mSpriteAntialiased(false)
 {
 }
 
@@ -385,7 +408,8 @@ QCPScatterStyle::QCPScatterStyle(ScatterShape shape, const QColor &color, const
   mShape(shape),
   mPen(QPen(color)),
   mBrush(QBrush(fill)),
-  mPenDefined(true)
+  mPenDefined(true),
+  mSpriteAntialiased(false)
 {
 }
 
@@ -409,7 +433,8 @@ QCPScatterStyle::QCPScatterStyle(ScatterShape shape, const QPen &pen, const QBru
   mShape(shape),
   mPen(pen),
   mBrush(brush),
-  mPenDefined(pen.style() != Qt::NoPen)
+  mPenDefined(pen.style() != Qt::NoPen),
+  mSpriteAntialiased(false)
 {
 }
 
@@ -423,7 +448,8 @@ QCPScatterStyle::QCPScatterStyle(const QPixmap &pixmap) :
   mPen(Qt::NoPen),
   mBrush(Qt::NoBrush),
   mPixmap(pixmap),
-  mPenDefined(false)
+  mPenDefined(false),
+  mSpriteAntialiased(false)
 {
 }
 
@@ -442,7 +468,8 @@ QCPScatterStyle::QCPScatterStyle(const QPainterPath &customPath, const QPen &pen
   mPen(pen),
   mBrush(brush),
   mCustomPath(customPath),
-  mPenDefined(pen.style() != Qt::NoPen)
+  mPenDefined(pen.style() != Qt::NoPen),
+  mSpriteAntialiased(false)
 {
 }
 
@@ -454,6 +481,7 @@ QCPScatterStyle::QCPScatterStyle(const QPainterPath &customPath, const QPen &pen
 void QCPScatterStyle::setSize(double size)
 {
   mSize = size;
+  mSprite = QPixmap();
 }
 
 /*!
@@ -467,6 +495,7 @@ void QCPScatterStyle::setSize(double size)
 void QCPScatterStyle::setShape(QCPScatterStyle::ScatterShape shape)
 {
   mShape = shape;
+  mSprite = QPixmap();
 }
 
 /*!
@@ -505,6 +534,7 @@ void QCPScatterStyle::setPixmap(const QPixmap &pixmap)
 {
   setShape(ssPixmap);
   mPixmap = pixmap;
+  mSprite = QPixmap();
 }
 
 /*!
@@ -516,6 +546,7 @@ void QCPScatterStyle::setCustomPath(const QPainterPath &customPath)
 {
   setShape(ssCustom);
   mCustomPath = customPath;
+  mSprite = QPixmap();
 }
 
 /*!
@@ -673,6 +704,130 @@ void QCPScatterStyle::drawShape(QCPPainter *painter, double x, double y) const
   }
 }
 
+/*!
+  Draws the scatter shape with \a painter at all \a positions. Positions with NaN coordinates are
+  skipped.
+  
+  If \a useSprite is true and the state of \a painter allows it (see \ref canUseSprite), the shape
+  isn't constructed and stroked for every position. Instead, it is rendered once with the current
+  pen, brush and antialiasing setting of \a painter into a sprite pixmap, which is kept until the
+  shape, size, pixmap or custom path of the scatter style changes. All scatters are then drawn as
+  a single batch of pixmap fragments (QPainter::drawPixmapFragments). Sprites are placed at whole
+  device pixels, so scatter positions are effectively rounded, like QPainter does for
+  non-antialiased drawing.
+  
+  Like \ref drawShape, this function does not modify the pen or the brush on the painter. Call
+  \ref applyTo before drawing.
+  
+  \see QCP::phCacheScatters
+*/
+void QCPScatterStyle::drawShapes(QCPPainter *painter, const QVector<QPointF> &positions, bool useSprite) const
+{
+  if (mShape == ssNone || positions.isEmpty())
+    return;
+  
+  if (!useSprite || !canUseSprite(painter))
+  {
+    for (int i=0; i<positions.size(); ++i)
+    {
+      if (!qIsNaN(positions.at(i).x()) && !qIsNaN(positions.at(i).y()))
+        drawShape(painter, positions.at(i));
+    }
+    return;
+  }
+  
+  updateSprite(painter);
+  if (mSprite.isNull())
+    return;
+  
+  // sprites are placed in device coordinates, so they align with whole pixels:
+  const QTransform oldTransform = painter->transform();
+  const QPointF shift = QPointF(oldTransform.dx(), oldTransform.dy())-mSpriteOffset;
+  const QPointF center(mSprite.width()*0.5, mSprite.height()*0.5);
+  const QRectF source(0, 0, mSprite.width(), mSprite.height());
+  QVector<QPainter::PixmapFragment> fragments;
+  fragments.reserve(positions.size());
+  for (int i=0; i<positions.size(); ++i)
+  {
+    const QPointF &pos = positions.at(i);
+    if (qIsNaN(pos.x()) || qIsNaN(pos.y()))
+      continue;
+    const QPointF topLeft(qRound(pos.x()+shift.x()), qRound(pos.y()+shift.y()));
+    fragments.append(QPainter::PixmapFragment::create(topLeft+center, source));
+  }
+  painter->setTransform(QTransform());
+  painter->drawPixmapFragments(fragments.constData(), fragments.size(), mSprite);
+  painter->setTransform(oldTransform);
+}
+
+/*! \internal
+  
+  Returns whether the scatters can be drawn as sprites with \a painter, without the result
+  differing noticeably from drawing them with \ref drawShape.
+  
+  This is not the case for vectorized and non-caching painters (e.g. PDF export), if the painter
+  transform scales or rotates, or if pen or brush have patterns that depend on the position of the
+  scatter, such as gradients.
+*/
+bool QCPScatterStyle::canUseSprite(const QCPPainter *painter) const
+{
+  if (painter->modes().testFlag(QCPPainter::pmVectorized) || painter->modes().testFlag(QCPPainter::pmNoCaching))
+    return false;
+  if (painter->transform().type() > QTransform::TxTranslate)
+    return false;
+  if (mShape == ssPixmap)
+    return !mPixmap.isNull();
+  const QPen pen = painter->pen();
+  if (pen.style() != Qt::NoPen && pen.brush().style() != Qt::SolidPattern)
+    return false;
+  const Qt::BrushStyle brushStyle = painter->brush().style();
+  return brushStyle == Qt::NoBrush || brushStyle == Qt::SolidPattern;
+}
+
+/*! \internal
+  
+  Makes sure \ref mSprite holds the scatter shape rendered with the pen, brush and antialiasing
+  setting of \a painter. The sprite is only rendered again if one of those differs from the ones
+  the current sprite was rendered with, or if the sprite was invalidated by a setter.
+  
+  \ref mSpriteOffset is set to the position of the scatter center inside the sprite, in device
+  pixels.
+*/
+void QCPScatterStyle::updateSprite(const QCPPainter *painter) const
+{
+  const QPen pen = painter->pen();
+  const QBrush brush = painter->brush();
+  const bool antialiased = painter->antialiasing();
+  if (!mSprite.isNull() && mSpritePen == pen && mSpriteBrush == brush && mSpriteAntialiased == antialiased)
+    return;
+  mSpritePen = pen;
+  mSpriteBrush = brush;
+  mSpriteAntialiased = antialiased;
+  
+  if (mShape == ssPixmap)
+  {
+    mSprite = mPixmap;
+    mSpriteOffset = QPointF(mPixmap.width()*0.5, mPixmap.height()*0.5);
+    return;
+  }
+  
+  double radius = mSize/2.0;
+  if (mShape == ssCustom)
+  {
+    const QRectF pathBounds = mCustomPath.boundingRect();
+    radius = qMax(qMax(qAbs(pathBounds.left()), qAbs(pathBounds.right())), qMax(qAbs(pathBounds.top()), qAbs(pathBounds.bottom())))*mSize/6.0;
+  }
+  const int half = qCeil(radius+qMax(qreal(1.0), pen.widthF()))+1;
+  mSprite = QPixmap(2*half+1, 2*half+1);
+  mSprite.fill(Qt::transparent);
+  QCPPainter spritePainter(&mSprite);
+  spritePainter.setAntialiasing(antialiased);
+  spritePainter.setPen(pen);
+  spritePainter.setBrush(brush);
+  drawShape(&spritePainter, half, half);
+  mSpriteOffset = QPointF(half+spritePainter.transform().dx(), half+spritePainter.transform().dy());
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPLayer
@@ -718,6 +873,11 @@ void QCPScatterStyle::drawShape(QCPPainter *painter, double x, double y) const
   
   When a layer is deleted, the objects on it are not deleted with it, but fall on the layer below
   the deleted layer, see QCustomPlot::removeLayer.
+  
+  Layers that contain frequently changing, lightweight elements (e.g. cursor lines, selection
+  rectangles or live value readouts) can be put in overlay mode with \ref setMode. An overlay layer
+  has its own buffer, which is composited on top of the rest of the plot. Calling \ref replot on
+  such a layer only redraws the layer's own elements.
 */
 
 /* start documentation of inline functions */
@@ -751,7 +911,8 @@ QCPLayer::QCPLayer(QCustomPlot *parentPlot, const QString &layerName) :
   mParentPlot(parentPlot),
   mName(layerName),
   mIndex(-1), // will be set to a proper value by the QCustomPlot layer creation function
-  mVisible(true)
+  mVisible(true),
+  mMode(lmBuffered)
 {
   // Note: no need to make sure layerName is unique, because layer
   // management is done with QCustomPlot functions.
@@ -784,6 +945,71 @@ void QCPLayer::setVisible(bool visible)
   mVisible = visible;
 }
 
+/*!
+  Sets how this layer is rendered.
+  
+  In \ref lmBuffered mode (the default), the layer is drawn into the main paint buffer of the
+  QCustomPlot, like all other layers. Any change requires a full \ref QCustomPlot::replot.
+  
+  In \ref lmOverlay mode, the layer is drawn into its own buffer. On repaints of the widget, the
+  overlay buffers are composited on top of the main paint buffer, in the order of their layer index.
+  Note that this means overlay layers always appear above all buffered layers, regardless of their
+  position in the layer list. When only elements on an overlay layer changed, call \ref replot of
+  this layer, which redraws just this layer and repaints the widget from the buffers.
+  
+  A full \ref QCustomPlot::replot redraws overlay layers, too. When exporting (e.g. \ref
+  QCustomPlot::savePng), overlay layers are drawn at their position in the layer list.
+  
+  \see QCustomPlot::setHoverLayer
+*/
+void QCPLayer::setMode(LayerMode mode)
+{
+  if (mMode != mode)
+  {
+    mMode = mode;
+    mOverlayBuffer = QPixmap(); // buffered layers don't need it, overlay layers create it on the next replot
+  }
+}
+
+/*!
+  Redraws this layer. If the layer is in overlay mode (\ref setMode), only the elements of this
+  layer are drawn into its buffer and the widget is repainted, without replotting the rest of the
+  plot. Otherwise, a regular \ref QCustomPlot::replot is performed.
+*/
+void QCPLayer::replot()
+{
+  if (mMode == lmOverlay && !mParentPlot->mPaintBuffer.isNull())
+  {
+    drawOverlayBuffer();
+    mParentPlot->update();
+  } else
+    mParentPlot->replot();
+}
+
+/*! \internal
+  
+  Draws the layerables of this overlay layer into the overlay buffer, which has the size of the main
+  paint buffer of the parent plot and is transparent everywhere else.
+  
+  \see QCustomPlot::paintEvent
+*/
+void QCPLayer::drawOverlayBuffer()
+{
+  if (mOverlayBuffer.size() != mParentPlot->mPaintBuffer.size())
+    mOverlayBuffer = QPixmap(mParentPlot->mPaintBuffer.size());
+  mOverlayBuffer.fill(Qt::transparent);
+  if (!mVisible)
+    return;
+  QCPPainter painter;
+  painter.begin(&mOverlayBuffer);
+  if (painter.isActive())
+  {
+    painter.setRenderHint(QPainter::HighQualityAntialiasing); // to make Antialiasing look good if using the OpenGL graphicssystem
+    mParentPlot->drawLayer(&painter, this);
+    painter.end();
+  }
+}
+
 /*! \internal
   
   Adds the \a layerable to the list of this layer. If \a prepend is set to true, the layerable will
@@ -1153,10 +1379,16 @@ bool QCPLayerable::moveToLayer(QCPLayer *layer, bool prepend)
   localAntialiased value as well as the overrides \ref QCustomPlot::setAntialiasedElements and \ref
   QCustomPlot::setNotAntialiasedElements. Which override enum this function takes into account is
   controlled via \a overrideElement.
+  
+  While the parent plot shows a reduced quality interaction preview with the simplification \ref
+  QCP::psNoAntialiasing (see \ref QCustomPlot::setPreviewSimplifications), antialiasing is always
+  disabled.
 */
 void QCPLayerable::applyAntialiasingHint(QCPPainter *painter, bool localAntialiased, QCP::AntialiasedElement overrideElement) const
 {
-  if (mParentPlot && mParentPlot->notAntialiasedElements().testFlag(overrideElement))
+  if (mParentPlot && mParentPlot->previewSimplified(QCP::psNoAntialiasing) && !painter->modes().testFlag(QCPPainter::pmNoCaching))
+    painter->setAntialiasing(false);
+  else if (mParentPlot && mParentPlot->notAntialiasedElements().testFlag(overrideElement))
     painter->setAntialiasing(false);
   else if (mParentPlot && mParentPlot->antialiasedElements().testFlag(overrideElement))
     painter->setAntialiasing(true);
@@ -1744,7 +1976,8 @@ QCPLayoutElement::QCPLayoutElement(QCustomPlot *parentPlot) :
   mOuterRect(0, 0, 0, 0),
   mMargins(0, 0, 0, 0),
   mMinimumMargins(0, 0, 0, 0),
-  mAutoMargins(QCP::msAll)
+  mAutoMargins(QCP::msAll),
+  mAutoMarginShrinkDelay(0)
 {
 }
 
@@ -1793,6 +2026,8 @@ void QCPLayoutElement::setMargins(const QMargins &margins)
   {
     mMargins = margins;
     mRect = mOuterRect.adjusted(mMargins.left(), mMargins.top(), -mMargins.right(), -mMargins.bottom());
+    if (mParentPlot)
+      mParentPlot->invalidateLayout();
   }
 }
 
@@ -1810,6 +2045,8 @@ void QCPLayoutElement::setMinimumMargins(const QMargins &margins)
   if (mMinimumMargins != margins)
   {
     mMinimumMargins = margins;
+    if (mParentPlot)
+      mParentPlot->invalidateLayout();
   }
 }
 
@@ -1825,9 +2062,32 @@ void QCPLayoutElement::setMinimumMargins(const QMargins &margins)
 */
 void QCPLayoutElement::setAutoMargins(QCP::MarginSides sides)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   mAutoMargins = sides;
 }
 
+/*!
+  Sets the number of consecutive replots for which an automatic margin keeps its size, when the
+  automatic margin calculation asks for a smaller margin. Larger margins are always applied
+  immediately.
+  
+  Automatic margins follow the size of the tick labels. If the tick labels alternate between
+  different widths, e.g. when the values of a live plot move between two and three digit numbers,
+  the margins and thus the axis rect would change with almost every replot, causing the plot to
+  jitter and the layout to be recalculated each time. With a delay of \a replots, a margin only
+  shrinks after it was found too large in that many replots in a row.
+  
+  The default of 0 applies every margin change immediately.
+  
+  \see setAutoMargins
+*/
+void QCPLayoutElement::setAutoMarginShrinkDelay(int replots)
+{
+  mAutoMarginShrinkDelay = qMax(0, replots);
+  mMarginShrinkCounts.clear();
+}
+
 /*!
   Sets the minimum size for the inner \ref rect of this layout element. A parent layout tries to
   respect the \a size here by changing row/column sizes in the layout accordingly.
@@ -1892,6 +2152,8 @@ void QCPLayoutElement::setMaximumSize(int width, int height)
 */
 void QCPLayoutElement::setMarginGroup(QCP::MarginSides sides, QCPMarginGroup *group)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   QVector<QCP::MarginSide> sideVector;
   if (sides.testFlag(QCP::msLeft)) sideVector.append(QCP::msLeft);
   if (sides.testFlag(QCP::msRight)) sideVector.append(QCP::msRight);
@@ -1951,6 +2213,16 @@ void QCPLayoutElement::update(UpdatePhase phase)
           // apply minimum margin restrictions:
           if (QCP::getMarginValue(newMargins, side) < QCP::getMarginValue(mMinimumMargins, side))
             QCP::setMarginValue(newMargins, side, QCP::getMarginValue(mMinimumMargins, side));
+          // keep the current margin if it shrinks, until it was too large for the shrink delay:
+          if (QCP::getMarginValue(newMargins, side) < QCP::getMarginValue(mMargins, side) && mAutoMarginShrinkDelay > 0)
+          {
+            int &shrinkCount = mMarginShrinkCounts[side];
+            if (++shrinkCount <= mAutoMarginShrinkDelay)
+              QCP::setMarginValue(newMargins, side, QCP::getMarginValue(mMargins, side));
+            else
+              shrinkCount = 0;
+          } else
+            mMarginShrinkCounts.remove(side);
         }
       }
       setMargins(newMargins);
@@ -2260,6 +2532,8 @@ void QCPLayout::clear()
 */
 void QCPLayout::sizeConstraintsChanged() const
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   if (QWidget *w = qobject_cast<QWidget*>(parent()))
     w->updateGeometry();
   else if (QCPLayout *l = qobject_cast<QCPLayout*>(parent()))
@@ -2297,6 +2571,8 @@ void QCPLayout::updateLayout()
 */
 void QCPLayout::adoptElement(QCPLayoutElement *el)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   if (el)
   {
     el->mParentLayout = this;
@@ -2320,6 +2596,8 @@ void QCPLayout::adoptElement(QCPLayoutElement *el)
 */
 void QCPLayout::releaseElement(QCPLayoutElement *el)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   if (el)
   {
     el->mParentLayout = 0;
@@ -2613,6 +2891,8 @@ bool QCPLayoutGrid::hasElement(int row, int column)
 */
 void QCPLayoutGrid::setColumnStretchFactor(int column, double factor)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   if (column >= 0 && column < columnCount())
   {
     if (factor > 0)
@@ -2636,6 +2916,8 @@ void QCPLayoutGrid::setColumnStretchFactor(int column, double factor)
 */
 void QCPLayoutGrid::setColumnStretchFactors(const QList<double> &factors)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   if (factors.size() == mColumnStretchFactors.size())
   {
     mColumnStretchFactors = factors;
@@ -2664,6 +2946,8 @@ void QCPLayoutGrid::setColumnStretchFactors(const QList<double> &factors)
 */
 void QCPLayoutGrid::setRowStretchFactor(int row, double factor)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   if (row >= 0 && row < rowCount())
   {
     if (factor > 0)
@@ -2687,6 +2971,8 @@ void QCPLayoutGrid::setRowStretchFactor(int row, double factor)
 */
 void QCPLayoutGrid::setRowStretchFactors(const QList<double> &factors)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   if (factors.size() == mRowStretchFactors.size())
   {
     mRowStretchFactors = factors;
@@ -2709,6 +2995,8 @@ void QCPLayoutGrid::setRowStretchFactors(const QList<double> &factors)
 */
 void QCPLayoutGrid::setColumnSpacing(int pixels)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   mColumnSpacing = pixels;
 }
 
@@ -2719,6 +3007,8 @@ void QCPLayoutGrid::setColumnSpacing(int pixels)
 */
 void QCPLayoutGrid::setRowSpacing(int pixels)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   mRowSpacing = pixels;
 }
 
@@ -2738,6 +3028,8 @@ void QCPLayoutGrid::setRowSpacing(int pixels)
 */
 void QCPLayoutGrid::expandTo(int newRowCount, int newColumnCount)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   // add rows as necessary:
   while (rowCount() < newRowCount)
   {
@@ -2763,6 +3055,8 @@ void QCPLayoutGrid::expandTo(int newRowCount, int newColumnCount)
 */
 void QCPLayoutGrid::insertRow(int newIndex)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   if (mElements.isEmpty() || mElements.first().isEmpty()) // if grid is completely empty, add first cell
   {
     expandTo(1, 1);
@@ -2789,6 +3083,8 @@ void QCPLayoutGrid::insertRow(int newIndex)
 */
 void QCPLayoutGrid::insertColumn(int newIndex)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   if (mElements.isEmpty() || mElements.first().isEmpty()) // if grid is completely empty, add first cell
   {
     expandTo(1, 1);
@@ -2916,6 +3212,8 @@ QList<QCPLayoutElement*> QCPLayoutGrid::elements(bool recursive) const
 */
 void QCPLayoutGrid::simplify()
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   // remove rows with only empty cells:
   for (int row=rowCount()-1; row>=0; --row)
   {
@@ -3154,6 +3452,8 @@ QRectF QCPLayoutInset::insetRect(int index) const
 */
 void QCPLayoutInset::setInsetPlacement(int index, QCPLayoutInset::InsetPlacement placement)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   if (elementAt(index))
     mInsetPlacement[index] = placement;
   else
@@ -3170,6 +3470,8 @@ void QCPLayoutInset::setInsetPlacement(int index, QCPLayoutInset::InsetPlacement
 */
 void QCPLayoutInset::setInsetAlignment(int index, Qt::Alignment alignment)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   if (elementAt(index))
     mInsetAlignment[index] = alignment;
   else
@@ -3189,6 +3491,8 @@ void QCPLayoutInset::setInsetAlignment(int index, Qt::Alignment alignment)
 */
 void QCPLayoutInset::setInsetRect(int index, const QRectF &rect)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   if (elementAt(index))
     mInsetRect[index] = rect;
   else
@@ -3781,7 +4085,7 @@ void QCPGrid::draw(QCPPainter *painter)
 {
   if (!mParentAxis) { qDebug() << Q_FUNC_INFO << "invalid parent axis"; return; }
   
-  if (mSubGridVisible)
+  if (mSubGridVisible && !mParentPlot->previewSimplified(QCP::psNoSubGrid))
     drawSubGridLines(painter);
   drawGridLines(painter);
 }
@@ -4056,7 +4360,11 @@ QCPAxis::QCPAxis(QCPAxisRect *parent, AxisType type) :
   mLowestVisibleTick(0),
   mHighestVisibleTick(-1),
   mCachedMarginValid(false),
-  mCachedMargin(0)
+  mCachedMargin(0),
+  mTickVectorStep(0),
+  mTickVectorFirstStep(0),
+  mTickVectorLastStep(-1),
+  mDateTimeLabelCache(256) // memoise at most 256 formatted date-time tick labels
 {
   mGrid->setVisible(false);
   setAntialiased(false);
@@ -4809,6 +5117,7 @@ void QCPAxis::setTickVector(const QVector<double> &vec)
 {
   // don't check whether mTickVector != vec here, because it takes longer than we would save
   mTickVector = vec;
+  mTickVectorStep = 0; // tick vector wasn't generated by generateAutoTicks, so it can't be reused there
   mCachedMarginValid = false;
 }
 
@@ -5589,14 +5898,15 @@ void QCPAxis::setupTickVectors()
         mTickVectorLabels[i] = mParentPlot->locale().toString(mTickVector.at(i), mNumberFormatChar.toLatin1(), mNumberPrecision);
     } else if (mTickLabelType == ltDateTime)
     {
-      for (int i=mLowestVisibleTick; i<=mHighestVisibleTick; ++i)
+      // formatted labels are memoised per tick value, they are only valid for the format, time spec and locale they were made with:
+      const QString cacheKey = mDateTimeFormat+QLatin1Char('\n')+QString::number(mDateTimeSpec)+QLatin1Char('\n')+mParentPlot->locale().name();
+      if (cacheKey != mDateTimeLabelCacheKey)
       {
-#if QT_VERSION < QT_VERSION_CHECK(4, 7, 0) // use fromMSecsSinceEpoch function if available, to gain sub-second accuracy on tick labels (e.g. for format "hh:mm:ss:zzz")
-        mTickVectorLabels[i] = mParentPlot->locale().toString(QDateTime::fromTime_t(mTickVector.at(i)).toTimeSpec(mDateTimeSpec), mDateTimeFormat);
-#else
-        mTickVectorLabels[i] = mParentPlot->locale().toString(QDateTime::fromMSecsSinceEpoch(mTickVector.at(i)*1000).toTimeSpec(mDateTimeSpec), mDateTimeFormat);
-#endif
+        mDateTimeLabelCache.clear();
+        mDateTimeLabelCacheKey = cacheKey;
       }
+      for (int i=mLowestVisibleTick; i<=mHighestVisibleTick; ++i)
+        mTickVectorLabels[i] = dateTimeTickLabel(mTickVector.at(i));
     }
   } else // mAutoTickLabels == false
   {
@@ -5610,6 +5920,29 @@ void QCPAxis::setupTickVectors()
   }
 }
 
+/*! \internal
+  
+  Returns the tick label of \a tick for the \ref ltDateTime label type, formatted with the current
+  date time format, time spec and locale.
+  
+  Formatting date-time labels is expensive, so the labels are memoised in a cache keyed by the tick
+  value. On a scrolling time axis, only the ticks that newly became visible need formatting. The
+  cache is cleared by \ref setupTickVectors when format, time spec or locale change.
+*/
+QString QCPAxis::dateTimeTickLabel(double tick)
+{
+  const qint64 msecs = tick*1000;
+  if (const QString *cachedLabel = mDateTimeLabelCache.object(msecs))
+    return *cachedLabel;
+#if QT_VERSION < QT_VERSION_CHECK(4, 7, 0) // use fromMSecsSinceEpoch function if available, to gain sub-second accuracy on tick labels (e.g. for format "hh:mm:ss:zzz")
+  const QString label = mParentPlot->locale().toString(QDateTime::fromTime_t(tick).toTimeSpec(mDateTimeSpec), mDateTimeFormat);
+#else
+  const QString label = mParentPlot->locale().toString(QDateTime::fromMSecsSinceEpoch(msecs).toTimeSpec(mDateTimeSpec), mDateTimeFormat);
+#endif
+  mDateTimeLabelCache.insert(msecs, new QString(label));
+  return label;
+}
+
 /*! \internal
   
   If \ref setAutoTicks is set to true, this function is called by \ref setupTickVectors to
@@ -5646,11 +5979,32 @@ void QCPAxis::generateAutoTicks()
     qint64 lastStep = ceil(mRange.upper/mTickStep); // do not use qCeil here, or we'll lose 64 bit precision
     int tickcount = lastStep-firstStep+1;
     if (tickcount < 0) tickcount = 0;
-    mTickVector.resize(tickcount);
-    for (int i=0; i<tickcount; ++i)
-      mTickVector[i] = (firstStep+i)*mTickStep;
+    if (mTickStep == mTickVectorStep && firstStep == mTickVectorFirstStep && lastStep == mTickVectorLastStep && mTickVector.size() == tickcount)
+      return; // range only shifted within the current ticks, previous tick vector is still valid
+    if (mTickStep == mTickVectorStep && firstStep <= mTickVectorLastStep && lastStep >= mTickVectorFirstStep && mTickVector.size() == mTickVectorLastStep-mTickVectorFirstStep+1)
+    {
+      // range shifted by whole ticks, keep the overlapping ticks and only add the newly visible ones:
+      if (firstStep > mTickVectorFirstStep)
+        mTickVector.remove(0, firstStep-mTickVectorFirstStep);
+      if (lastStep < mTickVectorLastStep)
+        mTickVector.resize(mTickVector.size()-(mTickVectorLastStep-lastStep));
+      for (qint64 step=mTickVectorFirstStep-1; step>=firstStep; --step)
+        mTickVector.prepend(step*mTickStep);
+      for (qint64 step=mTickVectorLastStep+1; step<=lastStep; ++step)
+        mTickVector.append(step*mTickStep);
+    } else
+    {
+      mTickVector.resize(tickcount);
+      for (int i=0; i<tickcount; ++i)
+        mTickVector[i] = (firstStep+i)*mTickStep;
+    }
+    mTickVectorStep = mTickStep;
+    mTickVectorFirstStep = firstStep;
+    mTickVectorLastStep = lastStep;
   } else // mScaleType == stLogarithmic
   {
+    mTickVectorStep = 0; // invalidate linear tick vector, see above
+
     // Generate tick positions according to logbase scaling:
     if (mRange.lower > 0 && mRange.upper > 0) // positive range
     {
@@ -6054,6 +6408,160 @@ QCP::Interaction QCPAxis::selectionCategory() const
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPLabelAtlasPrivate
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPLabelAtlasPrivate
+
+  \internal
+  \brief (Private)
+  
+  This is a private class and not part of the public QCustomPlot interface.
+  
+  It holds the rendered tick labels of all axes of all QCustomPlot instances, so labels that were
+  rendered once can be reused by any axis that draws the same text with the same font, color and
+  rotation. The cache key of a label is built by the axis painter from those parameters and the
+  text (see \ref QCPAxisPainterPrivate::generateLabelParameterHash).
+  
+  Additionally, it holds single glyphs keyed by font, color and character. New unrotated labels
+  are composed of these glyphs (see \ref QCPAxisPainterPrivate::createCachedLabel), so e.g. a
+  rolling time axis that shows a new label every second doesn't need to lay out and rasterize
+  text for every new label.
+  
+  Both caches evict the least recently used entries once their total pixel count exceeds a fixed
+  limit.
+  
+  There is only one instance, which is created by the first \ref acquire call and deleted when
+  the last user calls \ref release. It must only be used from the GUI thread.
+*/
+
+QCPLabelAtlasPrivate *QCPLabelAtlasPrivate::mInstance = 0;
+int QCPLabelAtlasPrivate::mReferenceCount = 0;
+
+/*!
+  Returns the shared label atlas, creating it if necessary. Every call must be balanced by a call
+  to \ref release.
+*/
+QCPLabelAtlasPrivate *QCPLabelAtlasPrivate::acquire()
+{
+  if (!mInstance)
+    mInstance = new QCPLabelAtlasPrivate;
+  ++mReferenceCount;
+  return mInstance;
+}
+
+/*!
+  Releases a reference to the shared label atlas obtained with \ref acquire. When the last
+  reference is released, the atlas and all cached labels and glyphs are deleted.
+*/
+void QCPLabelAtlasPrivate::release()
+{
+  if (mReferenceCount <= 0)
+  {
+    qDebug() << Q_FUNC_INFO << "label atlas released more often than acquired";
+    return;
+  }
+  if (--mReferenceCount == 0)
+  {
+    delete mInstance;
+    mInstance = 0;
+  }
+}
+
+/*! \internal
+  
+  Constructs the label atlas. Use \ref acquire to get the shared instance.
+*/
+QCPLabelAtlasPrivate::QCPLabelAtlasPrivate() :
+  mLabels(2*1024*1024), // cost is pixel count, so at most about 8 MB of labels
+  mGlyphs(256*1024)
+{
+}
+
+/*!
+  Looks up the label with \a key. If it exists, it is copied to \a label, marked as most recently
+  used and true is returned. Otherwise returns false.
+*/
+bool QCPLabelAtlasPrivate::findLabel(const QByteArray &key, Label *label)
+{
+  const Label *cachedLabel = mLabels.object(key);
+  if (!cachedLabel)
+    return false;
+  *label = *cachedLabel;
+  return true;
+}
+
+/*!
+  Inserts \a label into the atlas with the specified \a key, possibly evicting the least recently
+  used labels.
+*/
+void QCPLabelAtlasPrivate::insertLabel(const QByteArray &key, const Label &label)
+{
+  mLabels.insert(key, new Label(label), qMax(1, label.pixmap.width()*label.pixmap.height()));
+}
+
+/*!
+  Returns the glyph of \a character rendered with \a font and \a color, rendering it first if it
+  isn't in the atlas yet. \a fontKey must uniquely identify \a font and \a color, it is passed
+  in so it only needs to be generated once per label.
+  
+  The glyph pixmap is as high as the font and as wide as the advance of \a character, padded on
+  both sides by the parts of the glyph that overhang its advance (e.g. with italic fonts). The
+  pen position of the glyph is \a offset pixels right of the pixmap's left border, so glyphs of a
+  label are placed by drawing each pixmap at the pen position minus its offset. For characters
+  without advance (e.g. zero width characters), the pixmap is null.
+*/
+QCPLabelAtlasPrivate::Glyph QCPLabelAtlasPrivate::glyph(const QByteArray &fontKey, const QFont &font, const QColor &color, QChar character)
+{
+  const QByteArray key = fontKey+QByteArray::number(character.unicode(), 16);
+  if (const Glyph *cachedGlyph = mGlyphs.object(key))
+    return *cachedGlyph;
+  
+  Glyph result;
+  const QFontMetrics metrics(font);
+  result.advance = glyphAdvance(QFontMetricsF(font), character);
+  result.offset = 0;
+  if (result.advance > 0)
+  {
+    // negative bearings mean the glyph overhangs its advance, pad the pixmap so it isn't clipped:
+    result.offset = qMax(0, -metrics.leftBearing(character));
+    const int rightPadding = qMax(0, -metrics.rightBearing(character));
+    result.pixmap = QPixmap(result.offset+qCeil(result.advance)+rightPadding, metrics.height());
+    result.pixmap.fill(Qt::transparent);
+    QCPPainter glyphPainter(&result.pixmap);
+    glyphPainter.setFont(font);
+    glyphPainter.setPen(QPen(color));
+    glyphPainter.drawText(result.offset, 0, result.pixmap.width()-result.offset, result.pixmap.height(), Qt::TextDontClip, QString(character));
+  }
+  mGlyphs.insert(key, new Glyph(result), qMax(1, result.pixmap.width()*result.pixmap.height()));
+  return result;
+}
+
+/*!
+  Removes all labels and glyphs from the atlas.
+*/
+void QCPLabelAtlasPrivate::clear()
+{
+  mLabels.clear();
+  mGlyphs.clear();
+}
+
+/*!
+  Returns the unrounded advance of \a character with the font of \a metrics, i.e. the distance the
+  pen position moves after drawing the character. Unlike QFontMetrics, the advance isn't rounded
+  to full pixels, so labels composed of many glyphs don't accumulate rounding errors.
+*/
+double QCPLabelAtlasPrivate::glyphAdvance(const QFontMetricsF &metrics, QChar character)
+{
+#if QT_VERSION < QT_VERSION_CHECK(5, 11, 0)
+  return metrics.width(character);
+#else
+  return metrics.horizontalAdvance(character);
+#endif
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPAxisPainterPrivate
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -6066,8 +6574,9 @@ QCP::Interaction QCPAxis::selectionCategory() const
   This is a private class and not part of the public QCustomPlot interface.
   
   It is used by QCPAxis to do the low-level drawing of axis backbone, tick marks, tick labels and
-  axis label. It also buffers the labels to reduce replot times. The parameters are configured by
-  directly accessing the public member variables.
+  axis label. It also buffers the labels in the label atlas shared by all axes (\ref
+  QCPLabelAtlasPrivate) to reduce replot times. The parameters are configured by directly accessing
+  the public member variables.
 */
 
 /*!
@@ -6095,12 +6604,13 @@ QCPAxisPainterPrivate::QCPAxisPainterPrivate(QCustomPlot *parentPlot) :
   abbreviateDecimalPowers(false),
   reversedEndings(false),
   mParentPlot(parentPlot),
-  mLabelCache(16) // cache at most 16 (tick) labels
+  mLabelAtlas(QCPLabelAtlasPrivate::acquire())
 {
 }
 
 QCPAxisPainterPrivate::~QCPAxisPainterPrivate()
 {
+  QCPLabelAtlasPrivate::release();
 }
 
 /*! \internal
@@ -6112,12 +6622,7 @@ QCPAxisPainterPrivate::~QCPAxisPainterPrivate()
 */
 void QCPAxisPainterPrivate::draw(QCPPainter *painter)
 {
-  QByteArray newHash = generateLabelParameterHash();
-  if (newHash != mLabelParameterHash)
-  {
-    mLabelCache.clear();
-    mLabelParameterHash = newHash;
-  }
+  mLabelParameterHash = generateLabelParameterHash();
   
   QPoint origin;
   switch (type)
@@ -6317,6 +6822,7 @@ int QCPAxisPainterPrivate::size() const
     QSize tickLabelsSize(0, 0);
     if (!tickLabels.isEmpty())
     {
+      mLabelParameterHash = generateLabelParameterHash(); // the layout pass may run before draw with changed label parameters
       for (int i=0; i<tickLabels.size(); ++i)
         getMaxTickLabelSize(tickLabelFont, tickLabels.at(i), &tickLabelsSize);
       result += QCPAxis::orientation(type) == Qt::Horizontal ? tickLabelsSize.height() : tickLabelsSize.width();
@@ -6338,31 +6844,35 @@ int QCPAxisPainterPrivate::size() const
 
 /*! \internal
   
-  Clears the internal label cache. Upon the next \ref draw, all labels will be created new. This
-  method is called automatically in \ref draw, if any parameters have changed that invalidate the
-  cached labels, such as font, color, etc.
+  Clears the shared label atlas. Upon the next \ref draw of any axis, all labels will be created
+  new. Since the atlas is keyed by all parameters that influence the appearance of a label, this
+  isn't necessary when parameters like font or color change.
 */
 void QCPAxisPainterPrivate::clearCache()
 {
-  mLabelCache.clear();
+  mLabelAtlas->clear();
 }
 
 /*! \internal
   
-  Returns a hash that allows uniquely identifying whether the label parameters have changed such
-  that the cached labels must be refreshed (\ref clearCache). It is used in \ref draw. If the
-  return value of this method hasn't changed since the last redraw, the respective label parameters
-  haven't changed and cached labels may be used.
+  Returns a hash that uniquely identifies the label parameters which influence how a label with a
+  given text looks, such as font, color and rotation. Together with the label text, it forms the
+  key of the label in the shared label atlas (\ref QCPLabelAtlasPrivate). Axes with equal hashes
+  share their cached labels.
+  
+  Parameters that only influence where a label is placed (e.g. the tick label side) are not part of
+  the hash.
 */
 QByteArray QCPAxisPainterPrivate::generateLabelParameterHash() const
 {
   QByteArray result;
   result.append(QByteArray::number(tickLabelRotation));
-  result.append(QByteArray::number((int)tickLabelSide));
   result.append(QByteArray::number((int)substituteExponent));
   result.append(QByteArray::number((int)numberMultiplyCross));
+  result.append(QByteArray::number((int)abbreviateDecimalPowers));
   result.append(tickLabelColor.name().toLatin1()+QByteArray::number(tickLabelColor.alpha(), 16));
   result.append(tickLabelFont.toString().toLatin1());
+  result.append('\n');
   return result;
 }
 
@@ -6400,33 +6910,32 @@ void QCPAxisPainterPrivate::placeTickLabel(QCPPainter *painter, double position,
   }
   if (mParentPlot->plottingHints().testFlag(QCP::phCacheLabels) && !painter->modes().testFlag(QCPPainter::pmNoCaching)) // label caching enabled
   {
-    CachedLabel *cachedLabel = mLabelCache.take(text); // attempt to get label from cache
-    if (!cachedLabel)  // no cached label existed, create it
+    const QByteArray key = mLabelParameterHash+text.toUtf8();
+    QCPLabelAtlasPrivate::Label cachedLabel;
+    if (!mLabelAtlas->findLabel(key, &cachedLabel)) // no cached label existed, create it
     {
-      cachedLabel = new CachedLabel;
-      TickLabelData labelData = getTickLabelData(painter->font(), text);
-      cachedLabel->offset = getTickLabelDrawOffset(labelData)+labelData.rotatedTotalBounds.topLeft();
-      cachedLabel->pixmap = QPixmap(labelData.rotatedTotalBounds.size());
-      cachedLabel->pixmap.fill(Qt::transparent);
-      QCPPainter cachePainter(&cachedLabel->pixmap);
-      cachePainter.setPen(painter->pen());
-      drawTickLabel(&cachePainter, -labelData.rotatedTotalBounds.topLeft().x(), -labelData.rotatedTotalBounds.topLeft().y(), labelData);
+      cachedLabel = createCachedLabel(painter, text);
+      mLabelAtlas->insertLabel(key, cachedLabel);
     }
+    // the offset depends on the axis the label is placed on, so it isn't part of the shared label:
+    TickLabelData labelData;
+    labelData.totalBounds = cachedLabel.totalBounds;
+    labelData.rotatedTotalBounds = cachedLabel.rotatedTotalBounds;
+    const QPointF labelOffset = getTickLabelDrawOffset(labelData)+labelData.rotatedTotalBounds.topLeft();
     // if label would be partly clipped by widget border on sides, don't draw it (only for outside tick labels):
     bool labelClippedByBorder = false;
     if (tickLabelSide == QCPAxis::lsOutside)
     {
       if (QCPAxis::orientation(type) == Qt::Horizontal)
-        labelClippedByBorder = labelAnchor.x()+cachedLabel->offset.x()+cachedLabel->pixmap.width() > viewportRect.right() || labelAnchor.x()+cachedLabel->offset.x() < viewportRect.left();
+        labelClippedByBorder = labelAnchor.x()+labelOffset.x()+cachedLabel.pixmap.width() > viewportRect.right() || labelAnchor.x()+labelOffset.x() < viewportRect.left();
       else
-        labelClippedByBorder = labelAnchor.y()+cachedLabel->offset.y()+cachedLabel->pixmap.height() > viewportRect.bottom() || labelAnchor.y()+cachedLabel->offset.y() < viewportRect.top();
+        labelClippedByBorder = labelAnchor.y()+labelOffset.y()+cachedLabel.pixmap.height() > viewportRect.bottom() || labelAnchor.y()+labelOffset.y() < viewportRect.top();
     }
     if (!labelClippedByBorder)
     {
-      painter->drawPixmap(labelAnchor+cachedLabel->offset, cachedLabel->pixmap);
-      finalSize = cachedLabel->pixmap.size();
+      painter->drawPixmap(labelAnchor+labelOffset, cachedLabel.pixmap);
+      finalSize = cachedLabel.pixmap.size();
     }
-    mLabelCache.insert(text, cachedLabel); // return label to cache or insert for the first time if newly created
   } else // label caching disabled, draw text directly on surface:
   {
     TickLabelData labelData = getTickLabelData(painter->font(), text);
@@ -6676,11 +7185,14 @@ void QCPAxisPainterPrivate::getMaxTickLabelSize(const QFont &font, const QString
 {
   // note: this function must return the same tick label sizes as the placeTickLabel function.
   QSize finalSize;
-  if (mParentPlot->plottingHints().testFlag(QCP::phCacheLabels) && mLabelCache.contains(text)) // label caching enabled and have cached label
+  QCPLabelAtlasPrivate::Label cachedLabel;
+  if (mParentPlot->plottingHints().testFlag(QCP::phCacheLabels) && mLabelAtlas->findLabel(mLabelParameterHash+text.toUtf8(), &cachedLabel)) // label caching enabled and have cached label
   {
-    const CachedLabel *cachedLabel = mLabelCache.object(text);
-    finalSize = cachedLabel->pixmap.size();
-  } else // label caching disabled or no label with this text cached:
+    finalSize = cachedLabel.pixmap.size();
+  } else if (mParentPlot->plottingHints().testFlag(QCP::phCacheLabels) && canComposeTickLabel(text)) // label will be composed of glyphs when drawn
+  {
+    finalSize = composedTickLabelSize(font, text);
+  } else // label caching disabled or label will be laid out as text:
   {
     TickLabelData labelData = getTickLabelData(font, text);
     finalSize = labelData.rotatedTotalBounds.size();
@@ -6693,42 +7205,142 @@ void QCPAxisPainterPrivate::getMaxTickLabelSize(const QFont &font, const QString
     tickLabelsSize->setHeight(finalSize.height());
 }
 
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// QCPAbstractPlottable
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-/*! \class QCPAbstractPlottable
-  \brief The abstract base class for all data representing objects in a plot.
-
-  It defines a very basic interface like name, pen, brush, visibility etc. Since this class is
-  abstract, it can't be instantiated. Use one of the subclasses or create a subclass yourself to
-  create new ways of displaying data (see "Creating own plottables" below).
-  
-  All further specifics are in the subclasses, for example:
-  \li A normal graph with possibly a line, scatter points and error bars: \ref QCPGraph
-  (typically created with \ref QCustomPlot::addGraph)
-  \li A parametric curve: \ref QCPCurve
-  \li A bar chart: \ref QCPBars
-  \li A statistical box plot: \ref QCPStatisticalBox
-  \li A color encoded two-dimensional map: \ref QCPColorMap
-  \li An OHLC/Candlestick chart: \ref QCPFinancial
-  
-  \section plottables-subclassing Creating own plottables
+/*! \internal
   
-  To create an own plottable, you implement a subclass of QCPAbstractPlottable. These are the pure
-  virtual functions, you must implement:
-  \li \ref clearData
-  \li \ref selectTest
-  \li \ref draw
-  \li \ref drawLegendIcon
-  \li \ref getKeyRange
-  \li \ref getValueRange
+  This is a \ref placeTickLabel helper function.
   
-  See the documentation of those functions for what they need to do.
+  Renders the tick label \a text with the font and pen currently set on \a painter into a new
+  label for the shared label atlas.
   
-  For drawing your plot, you can use the \ref coordsToPixels functions to translate a point in plot
-  coordinates to pixel coordinates. This function is quite convenient, because it takes the
+  If the label can be composed of single glyphs (see \ref canComposeTickLabel), the glyphs are
+  taken from the atlas and placed next to each other, so no text layout pass is necessary.
+  Otherwise the label is drawn with \ref drawTickLabel, like when label caching is disabled.
+*/
+QCPLabelAtlasPrivate::Label QCPAxisPainterPrivate::createCachedLabel(QCPPainter *painter, const QString &text) const
+{
+  QCPLabelAtlasPrivate::Label result;
+  if (canComposeTickLabel(text))
+  {
+    const QFont font = painter->font();
+    const QColor color = painter->pen().color();
+    int leftPadding = 0;
+    result.totalBounds = QRect(QPoint(0, 0), composedTickLabelSize(font, text, &leftPadding));
+    result.rotatedTotalBounds = result.totalBounds;
+    if (result.totalBounds.isEmpty())
+      return result;
+    result.pixmap = QPixmap(result.totalBounds.size());
+    result.pixmap.fill(Qt::transparent);
+    const QByteArray fontKey = font.toString().toLatin1()+'/'+QByteArray::number(color.rgba(), 16)+'/';
+    QPainter labelPainter(&result.pixmap);
+    double x = leftPadding; // accumulate unrounded advances, so rounding errors don't add up over the label
+    for (int i=0; i<text.size(); ++i)
+    {
+      const QCPLabelAtlasPrivate::Glyph glyph = mLabelAtlas->glyph(fontKey, font, color, text.at(i));
+      if (!glyph.pixmap.isNull())
+        labelPainter.drawPixmap(qRound(x)-glyph.offset, 0, glyph.pixmap);
+      x += glyph.advance;
+    }
+  } else
+  {
+    TickLabelData labelData = getTickLabelData(painter->font(), text);
+    result.totalBounds = labelData.totalBounds;
+    result.rotatedTotalBounds = labelData.rotatedTotalBounds;
+    result.pixmap = QPixmap(labelData.rotatedTotalBounds.size());
+    result.pixmap.fill(Qt::transparent);
+    QCPPainter cachePainter(&result.pixmap);
+    cachePainter.setPen(painter->pen());
+    drawTickLabel(&cachePainter, -labelData.rotatedTotalBounds.topLeft().x(), -labelData.rotatedTotalBounds.topLeft().y(), labelData);
+  }
+  return result;
+}
+
+/*! \internal
+  
+  Returns whether the tick label \a text can be composed of single glyphs by \ref
+  createCachedLabel. This is the case for unrotated labels that don't need beautiful decimal powers
+  and only consist of characters that aren't combined with their neighbours, such as digits, latin
+  letters and punctuation. This covers number and single-line date-time tick labels. Labels with
+  line breaks or other non-printable characters are laid out as text.
+*/
+bool QCPAxisPainterPrivate::canComposeTickLabel(const QString &text) const
+{
+  if (!qFuzzyIsNull(tickLabelRotation))
+    return false;
+  if (substituteExponent && text.contains(QLatin1Char('e'))) // beautiful powers are drawn with two fonts
+    return false;
+  for (int i=0; i<text.size(); ++i)
+  {
+    if (text.at(i).unicode() >= 0x0300) // combining diacritics and complex scripts need text layout
+      return false;
+    if (!text.at(i).isPrint()) // line breaks (e.g. in date-time formats) and other control characters need text layout
+      return false;
+  }
+  return true;
+}
+
+/*! \internal
+  
+  Returns the size of the tick label \a text with \a font, when composed of single glyphs by \ref
+  createCachedLabel. The width is the sum of the glyph advances, padded by the parts of the first
+  and last glyph that overhang their advance (see \ref QCPLabelAtlasPrivate::glyph). The height is
+  the font height.
+  
+  If \a leftPadding is not zero, it is set to the padding on the left, i.e. the pen position of the
+  first glyph inside the label.
+  
+  Kerning between neighbouring glyphs is not applied, which is irrelevant for the digits and
+  separators of typical tick labels, since fonts give digits equal advances.
+*/
+QSize QCPAxisPainterPrivate::composedTickLabelSize(const QFont &font, const QString &text, int *leftPadding) const
+{
+  const QFontMetrics metrics(font);
+  const QFontMetricsF metricsF(font);
+  double width = 0;
+  for (int i=0; i<text.size(); ++i)
+    width += QCPLabelAtlasPrivate::glyphAdvance(metricsF, text.at(i));
+  const int left = text.isEmpty() ? 0 : qMax(0, -metrics.leftBearing(text.at(0)));
+  const int right = text.isEmpty() ? 0 : qMax(0, -metrics.rightBearing(text.at(text.size()-1)));
+  if (leftPadding)
+    *leftPadding = left;
+  return QSize(left+qCeil(width)+right, metrics.height());
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPAbstractPlottable
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPAbstractPlottable
+  \brief The abstract base class for all data representing objects in a plot.
+
+  It defines a very basic interface like name, pen, brush, visibility etc. Since this class is
+  abstract, it can't be instantiated. Use one of the subclasses or create a subclass yourself to
+  create new ways of displaying data (see "Creating own plottables" below).
+  
+  All further specifics are in the subclasses, for example:
+  \li A normal graph with possibly a line, scatter points and error bars: \ref QCPGraph
+  (typically created with \ref QCustomPlot::addGraph)
+  \li A parametric curve: \ref QCPCurve
+  \li A bar chart: \ref QCPBars
+  \li A statistical box plot: \ref QCPStatisticalBox
+  \li A color encoded two-dimensional map: \ref QCPColorMap
+  \li An OHLC/Candlestick chart: \ref QCPFinancial
+  
+  \section plottables-subclassing Creating own plottables
+  
+  To create an own plottable, you implement a subclass of QCPAbstractPlottable. These are the pure
+  virtual functions, you must implement:
+  \li \ref clearData
+  \li \ref selectTest
+  \li \ref draw
+  \li \ref drawLegendIcon
+  \li \ref getKeyRange
+  \li \ref getValueRange
+  
+  See the documentation of those functions for what they need to do.
+  
+  For drawing your plot, you can use the \ref coordsToPixels functions to translate a point in plot
+  coordinates to pixel coordinates. This function is quite convenient, because it takes the
   orientation of the key and value axes into account for you (x and y are swapped when the key axis
   is vertical and the value axis horizontal). If you are worried about performance (i.e. you need
   to translate many points in a loop like QCPGraph), you can directly use \ref
@@ -6858,7 +7470,8 @@ QCPAbstractPlottable::QCPAbstractPlottable(QCPAxis *keyAxis, QCPAxis *valueAxis)
   mKeyAxis(keyAxis),
   mValueAxis(valueAxis),
   mSelectable(true),
-  mSelected(false)
+  mSelected(false),
+  mDataVersion(0)
 {
   if (keyAxis->parentPlot() != valueAxis->parentPlot())
     qDebug() << Q_FUNC_INFO << "Parent plot of keyAxis is not the same as that of valueAxis.";
@@ -6872,6 +7485,8 @@ QCPAbstractPlottable::QCPAbstractPlottable(QCPAxis *keyAxis, QCPAxis *valueAxis)
 */
 void QCPAbstractPlottable::setName(const QString &name)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   mName = name;
 }
 
@@ -8753,6 +9368,22 @@ QCP::Interaction QCPAbstractItem::selectionCategory() const
   one cell with the main QCPAxisRect inside.
 */
 
+/*! \fn void QCustomPlot::invalidateLayout()
+  
+  Makes the next replot perform the layout pass, even if layout caching is enabled and QCustomPlot
+  didn't detect a structural change. Layout elements call this automatically when their margins,
+  size constraints or layout properties change.
+  
+  \see setLayoutCaching
+*/
+
+/*! \fn bool QCustomPlot::previewSimplified(QCP::PreviewSimplification simplification) const
+  
+  Returns whether the current replot is an interaction preview (see \ref interactionPreview) and
+  \a simplification is enabled in \ref setPreviewSimplifications. Plottables and other layerables
+  call this in their draw methods to decide whether to skip or coarsen details.
+*/
+
 /* end of documentation of inline functions */
 /* start of documentation of signals */
 
@@ -8943,6 +9574,16 @@ QCP::Interaction QCPAbstractItem::selectionCategory() const
   \see replot, beforeReplot
 */
 
+/*! \fn void QCustomPlot::exportFinished(const QString &fileName, bool success)
+  
+  This signal is emitted when an export that was started with \ref savePdfAsync, \ref
+  savePngAsync or \ref saveRasteredAsync has finished writing the file \a fileName. \a success
+  tells whether the file was written successfully.
+  
+  The signal is always emitted in the thread of the QCustomPlot (i.e. the GUI thread), so it is
+  safe to access the plot from a connected slot.
+*/
+
 /* end of documentation of signals */
 /* start of documentation of public members */
 
@@ -9036,16 +9677,31 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   mInteractions(0),
   mSelectionTolerance(8),
   mNoAntialiasingOnDrag(false),
+  mQueuedReplotInterval(16),
+  mProgressiveRefinement(false),
+  mRefinementDelay(150),
+  mLayoutCaching(true),
+  mPreviewSimplifications(QCP::psNoAntialiasing),
   mBackgroundBrush(Qt::white, Qt::SolidPattern),
   mBackgroundScaled(true),
   mBackgroundScaledMode(Qt::KeepAspectRatioByExpanding),
   mCurrentLayer(0),
-  mPlottingHints(QCP::phCacheLabels|QCP::phForceRepaint),
+  mHoverLayer(0),
+  mPlottingHints(QCP::phCacheLabels|QCP::phForceRepaint|QCP::phCacheScatters),
   mMultiSelectModifier(Qt::ControlModifier),
   mPaintBuffer(size()),
   mMouseEventElement(0),
-  mReplotting(false)
-{
+  mReplotting(false),
+  mLayoutValid(false),
+  mQueuedReplotTimer(new QTimer(this)),
+  mRefinementTimer(new QTimer(this)),
+  mInteractionPreview(false)
+{
+  mQueuedReplotTimer->setSingleShot(true);
+  connect(mQueuedReplotTimer, SIGNAL(timeout()), this, SLOT(replot()));
+  mRefinementTimer->setSingleShot(true);
+  connect(mRefinementTimer, SIGNAL(timeout()), this, SLOT(refineReplot()));
+  mLastReplotTime.start();
   setAttribute(Qt::WA_NoMousePropagation);
   setAttribute(Qt::WA_OpaquePaintEvent);
   setMouseTracking(true);
@@ -9096,6 +9752,14 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
 
 QCustomPlot::~QCustomPlot()
 {
+  // exports still running must finish before the plot goes away, they only hold their own snapshot though:
+  foreach (QCPExportJob *job, mExportJobs)
+  {
+    job->wait();
+    delete job;
+  }
+  mExportJobs.clear();
+  
   clearPlottables();
   clearItems();
 
@@ -9106,6 +9770,7 @@ QCustomPlot::~QCustomPlot()
   }
   
   mCurrentLayer = 0;
+  mHoverLayer = 0;
   qDeleteAll(mLayers); // don't use removeLayer, because it would prevent the last layer to be removed
   mLayers.clear();
 }
@@ -9318,6 +9983,102 @@ void QCustomPlot::setNoAntialiasingOnDrag(bool enabled)
   mNoAntialiasingOnDrag = enabled;
 }
 
+/*!
+  Sets the minimum time in \a milliseconds between the start of two replots, when replots are
+  requested with \ref replot(QCustomPlot::RefreshPriority) "replot(rpQueuedReplot)".
+  
+  Queued replots are coalesced: No matter how many are requested, only one replot is performed once
+  the interval since the last replot has passed, and it shows the state at that time. Range
+  dragging and zooming with the mouse use queued replots, so fast mouse movements don't cause a
+  backlog of replots and the plot keeps up with the cursor. The default of 16 milliseconds limits
+  interactive replots to about one per display frame at 60 Hz.
+  
+  An interval of 0 performs the queued replot in the next event loop iteration.
+  
+  \see setProgressiveRefinement
+*/
+void QCustomPlot::setQueuedReplotInterval(int milliseconds)
+{
+  mQueuedReplotInterval = qMax(0, milliseconds);
+}
+
+/*!
+  Sets whether replots caused by range dragging and zooming with the mouse are rendered as fast,
+  reduced quality previews, which are refined with a regular replot as soon as the user stops
+  interacting.
+  
+  While a preview is shown, \ref interactionPreview returns true, and the plot is drawn with the
+  simplifications set with \ref setPreviewSimplifications. The refining replot is performed when
+  the user releases the mouse button after a drag, or once no interaction happened for the time set
+  with \ref setRefinementDelay, e.g. when the user pauses a drag, or stops turning the mouse wheel.
+  
+  \see setQueuedReplotInterval, setNoAntialiasingOnDrag
+*/
+void QCustomPlot::setProgressiveRefinement(bool enabled)
+{
+  mProgressiveRefinement = enabled;
+  if (!enabled && mInteractionPreview)
+    refineReplot();
+}
+
+/*!
+  Sets the time in \a milliseconds without user interaction, after which a reduced quality preview
+  is refined with a regular replot.
+  
+  \see setProgressiveRefinement
+*/
+void QCustomPlot::setRefinementDelay(int milliseconds)
+{
+  mRefinementDelay = qMax(0, milliseconds);
+}
+
+/*!
+  Sets whether the positions and sizes of the layout elements are reused between replots.
+  
+  When enabled (the default), the layout pass (\ref QCPLayoutElement::upLayout) is only performed
+  when something structural changed since the last replot: the viewport was resized, layout
+  elements were added or removed, the margins of a layout element changed (e.g. because tick
+  labels became wider or narrower than the current axis margin), or layout properties like stretch
+  factors, spacings, size constraints, inset placements or legend fonts were modified. A live
+  replot that only changes data and axis ranges then skips the layout pass entirely.
+  
+  If you change something that influences the layout in a way QCustomPlot can't detect, e.g. in a
+  custom layout element subclass, call \ref invalidateLayout. Disabling layout caching restores
+  the full layout pass on every replot.
+*/
+void QCustomPlot::setLayoutCaching(bool enabled)
+{
+  mLayoutCaching = enabled;
+  mLayoutValid = false;
+}
+
+/*!
+  Sets which simplifications are applied to the reduced quality preview that is shown during range
+  dragging and zooming, when progressive refinement is enabled (\ref setProgressiveRefinement).
+  
+  The default is \ref QCP::psNoAntialiasing. Setting \ref QCP::psAll gives the fastest previews,
+  which is useful for plots with many data points, scatters or large color maps.
+  
+  \see setPreviewSimplification
+*/
+void QCustomPlot::setPreviewSimplifications(const QCP::PreviewSimplifications &simplifications)
+{
+  mPreviewSimplifications = simplifications;
+}
+
+/*!
+  Sets the specified \a simplification to \a enabled, leaving the others unchanged.
+  
+  \see setPreviewSimplifications
+*/
+void QCustomPlot::setPreviewSimplification(QCP::PreviewSimplification simplification, bool enabled)
+{
+  if (!enabled)
+    mPreviewSimplifications &= ~simplification;
+  else
+    mPreviewSimplifications |= simplification;
+}
+
 /*!
   Sets the plotting hints for this QCustomPlot instance as an \a or combination of QCP::PlottingHint.
   
@@ -9372,6 +10133,7 @@ void QCustomPlot::setViewport(const QRect &rect)
   mViewport = rect;
   if (mPlotLayout)
     mPlotLayout->setOuterRect(mViewport);
+  mLayoutValid = false;
 }
 
 /*!
@@ -10065,6 +10827,35 @@ bool QCustomPlot::setCurrentLayer(QCPLayer *layer)
   return true;
 }
 
+/*!
+  Sets the provided \a layer to be the hover layer, or disables the hover layer if \a layer is 0.
+  
+  The hover layer is not drawn into the internal buffer on \ref replot. Instead, it is drawn directly
+  on top of the buffer (and overlay layers, see \ref QCPLayer::setMode) whenever the widget is
+  repainted. This makes it suitable for elements that
+  follow the mouse cursor, like a QCPItemTracer that marks the graph point under the cursor and a
+  QCPItemText that shows its value: After changing them, call \ref replotHover instead of \ref
+  replot. Only the few elements on the hover layer are redrawn then, not the graphs underneath.
+  
+  Since the hover layer is redrawn on every repaint of the widget, it should only contain
+  lightweight elements.
+  
+  Returns true on success, i.e. when \a layer is a valid layer in the QCustomPlot or 0.
+  
+  \see addLayer
+*/
+bool QCustomPlot::setHoverLayer(QCPLayer *layer)
+{
+  if (layer && !mLayers.contains(layer))
+  {
+    qDebug() << Q_FUNC_INFO << "layer not a layer of this QCustomPlot:" << reinterpret_cast<quintptr>(layer);
+    return false;
+  }
+  
+  mHoverLayer = layer;
+  return true;
+}
+
 /*!
   Returns the number of currently existing layers in the plot
   
@@ -10153,6 +10944,8 @@ bool QCustomPlot::removeLayer(QCPLayer *layer)
   // if removed layer is current layer, change current layer to layer below/above:
   if (layer == mCurrentLayer)
     setCurrentLayer(targetLayer);
+  if (layer == mHoverLayer)
+    mHoverLayer = 0;
   // remove layer:
   delete layer;
   mLayers.removeOne(layer);
@@ -10369,8 +11162,16 @@ void QCustomPlot::deselectAll()
 */
 void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
 {
+  if (refreshPriority == rpQueuedReplot)
+  {
+    if (!mQueuedReplotTimer->isActive()) // a replot is already queued, it will show the latest state anyway
+      mQueuedReplotTimer->start(qMax(0, mQueuedReplotInterval-int(mLastReplotTime.elapsed())));
+    return;
+  }
   if (mReplotting) // incase signals loop back to replot slot
     return;
+  mQueuedReplotTimer->stop(); // this replot supersedes queued replots
+  mLastReplotTime.restart();
   mReplotting = true;
   emit beforeReplot();
   
@@ -10384,6 +11185,11 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
       painter.fillRect(mViewport, mBackgroundBrush);
     draw(&painter);
     painter.end();
+    foreach (QCPLayer *layer, mLayers)
+    {
+      if (layer->mode() == QCPLayer::lmOverlay && layer != mHoverLayer)
+        layer->drawOverlayBuffer();
+    }
     if ((refreshPriority == rpHint && mPlottingHints.testFlag(QCP::phForceRepaint)) || refreshPriority==rpImmediate)
       repaint();
     else
@@ -10395,6 +11201,21 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
   mReplotting = false;
 }
 
+/*!
+  Repaints the widget with the current state of the hover layer (see \ref setHoverLayer), reusing
+  the buffered plot underneath. Call this instead of \ref replot, when only elements on the hover
+  layer changed.
+  
+  If no hover layer is set, performs a regular \ref replot.
+*/
+void QCustomPlot::replotHover()
+{
+  if (mHoverLayer)
+    update();
+  else
+    replot();
+}
+
 /*!
   Rescales the axes such that all plottables (like graphs) in the plot are fully visible.
   
@@ -10661,8 +11482,18 @@ QSize QCustomPlot::sizeHint() const
 void QCustomPlot::paintEvent(QPaintEvent *event)
 {
   Q_UNUSED(event);
-  QPainter painter(this);
+  QCPPainter painter(this);
   painter.drawPixmap(0, 0, mPaintBuffer);
+  foreach (QCPLayer *layer, mLayers) // composite overlay layers, see QCPLayer::setMode
+  {
+    if (layer->mode() == QCPLayer::lmOverlay && layer != mHoverLayer && layer->visible() && !layer->mOverlayBuffer.isNull())
+      painter.drawPixmap(0, 0, layer->mOverlayBuffer);
+  }
+  if (mHoverLayer) // hover layer isn't part of the buffer, draw it on top, see setHoverLayer
+  {
+    painter.setRenderHint(QPainter::HighQualityAntialiasing);
+    drawLayer(&painter, mHoverLayer);
+  }
 }
 
 /*! \internal
@@ -10880,7 +11711,11 @@ void QCustomPlot::draw(QCPPainter *painter)
   // run through layout phases:
   mPlotLayout->update(QCPLayoutElement::upPreparation);
   mPlotLayout->update(QCPLayoutElement::upMargins);
-  mPlotLayout->update(QCPLayoutElement::upLayout);
+  if (!mLayoutCaching || !mLayoutValid) // margin changes in the previous phase invalidate the layout
+  {
+    mLayoutValid = true;
+    mPlotLayout->update(QCPLayoutElement::upLayout);
+  }
   
   // draw viewport background pixmap:
   drawBackground(painter);
@@ -10888,17 +11723,9 @@ void QCustomPlot::draw(QCPPainter *painter)
   // draw all layered objects (grid, axes, plottables, items, legend,...):
   foreach (QCPLayer *layer, mLayers)
   {
-    foreach (QCPLayerable *child, layer->children())
-    {
-      if (child->realVisibility())
-      {
-        painter->save();
-        painter->setClipRect(child->clipRect().translated(0, -1));
-        child->applyDefaultAntialiasingHint(painter);
-        child->draw(painter);
-        painter->restore();
-      }
-    }
+    if ((layer == mHoverLayer || layer->mode() == QCPLayer::lmOverlay) && painter->device() == &mPaintBuffer) // overlay and hover layers are drawn on top of the buffer in paintEvent
+      continue;
+    drawLayer(painter, layer);
   }
   
   /* Debug code to draw all layout element rects
@@ -10913,6 +11740,26 @@ void QCustomPlot::draw(QCPPainter *painter)
   */
 }
 
+/*! \internal
+  
+  Draws all visible layerables of \a layer with \a painter. Used by \ref draw for all layers, and
+  by \ref paintEvent for the hover layer.
+*/
+void QCustomPlot::drawLayer(QCPPainter *painter, QCPLayer *layer)
+{
+  foreach (QCPLayerable *child, layer->children())
+  {
+    if (child->realVisibility())
+    {
+      painter->save();
+      painter->setClipRect(child->clipRect().translated(0, -1));
+      child->applyDefaultAntialiasingHint(painter);
+      child->draw(painter);
+      painter->restore();
+    }
+  }
+}
+
 /*! \internal
   
   Draws the viewport background pixmap of the plot.
@@ -11144,67 +11991,444 @@ void QCustomPlot::toPainter(QCPPainter *painter, int width, int height)
     qDebug() << Q_FUNC_INFO << "Passed painter is not active";
 }
 
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// QCPColorGradient
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-/*! \class QCPColorGradient
-  \brief Defines a color gradient for use with e.g. \ref QCPColorMap
+/*!
+  Saves a PDF with the vectorized plot to the file \a fileName, like \ref savePdf, but without
+  blocking the GUI thread while the file is being written.
   
-  This class describes a color gradient which can be used to encode data with color. For example,
-  QCPColorMap and QCPColorScale have \ref QCPColorMap::setGradient "setGradient" methods which
-  take an instance of this class. Colors are set with \ref setColorStopAt(double position, const QColor &color)
-  with a \a position from 0 to 1. In between these defined color positions, the
-  color will be interpolated linearly either in RGB or HSV space, see \ref setColorInterpolation.
-
-  Alternatively, load one of the preset color gradients shown in the image below, with \ref
-  loadPreset, or by directly specifying the preset in the constructor.
+  The plot is laid out at the export size and its drawing commands are recorded into a QPicture
+  (this part still happens synchronously, but doesn't involve any rasterization). The recorded
+  snapshot is then handed to a \ref QCPExportJob which replays it into the PDF on a worker thread.
+  So after this function returns, the plot may be changed and replotted freely, the export will
+  still show the plot in the state it had at the time of the call.
   
-  \image html QCPColorGradient.png
+  When the file was written, the \ref exportFinished signal is emitted. The parameters have the
+  same meaning as in \ref savePdf.
   
-  The fact that the \ref QCPColorGradient(GradientPreset preset) constructor allows directly
-  converting a \ref GradientPreset to a QCPColorGradient, you can also directly pass \ref
-  GradientPreset to all the \a setGradient methods, e.g.:
-  \snippet documentation/doc-code-snippets/mainwindow.cpp qcpcolorgradient-setgradient
+  Returns true if the export job was started successfully. Whether the file itself could be
+  written is reported by \ref exportFinished.
   
-  The total number of levels used in the gradient can be set with \ref setLevelCount. Whether the
-  color gradient shall be applied periodically (wrapping around) to data values that lie outside
-  the data range specified on the plottable instance can be controlled with \ref setPeriodic.
+  \see savePngAsync, saveRasteredAsync, pendingExportCount
 */
+bool QCustomPlot::savePdfAsync(const QString &fileName, bool noCosmeticPen, int width, int height, const QString &pdfCreator, const QString &pdfTitle)
+{
+#ifdef QT_NO_PRINTER
+  Q_UNUSED(fileName)
+  Q_UNUSED(noCosmeticPen)
+  Q_UNUSED(width)
+  Q_UNUSED(height)
+  Q_UNUSED(pdfCreator)
+  Q_UNUSED(pdfTitle)
+  qDebug() << Q_FUNC_INFO << "Qt was built without printer support (QT_NO_PRINTER). PDF not created.";
+  return false;
+#else
+  int newWidth, newHeight;
+  if (width == 0 || height == 0)
+  {
+    newWidth = this->width();
+    newHeight = this->height();
+  } else
+  {
+    newWidth = width;
+    newHeight = height;
+  }
+  
+  QCPPainter::PainterModes modes = QCPPainter::pmVectorized|QCPPainter::pmNoCaching;
+  if (noCosmeticPen)
+    modes |= QCPPainter::pmNonCosmetic;
+  QBrush background(Qt::NoBrush);
+  if (mBackgroundBrush.style() != Qt::NoBrush &&
+      mBackgroundBrush.color() != Qt::white &&
+      mBackgroundBrush.color() != Qt::transparent &&
+      mBackgroundBrush.color().alpha() > 0) // draw pdf background color if not white/transparent
+    background = mBackgroundBrush;
+  
+  QPicture picture;
+  if (!recordPicture(&picture, newWidth, newHeight, modes, background))
+    return false;
+  QCPExportJob *job = new QCPExportJob(picture, QSize(newWidth, newHeight), fileName);
+  job->setPdfOutput(pdfCreator, pdfTitle, logicalDpiX());
+  startExportJob(job);
+  return true;
+#endif // QT_NO_PRINTER
+}
 
 /*!
-  Constructs a new QCPColorGradient initialized with the colors and color interpolation according
-  to \a preset.
+  Saves a PNG image file to \a fileName on disc, like \ref savePng, but without blocking the GUI
+  thread while the image is rasterized and encoded. See \ref saveRasteredAsync for details.
   
-  The color level count is initialized to 350.
+  \see savePdfAsync, saveRasteredAsync
 */
-QCPColorGradient::QCPColorGradient(GradientPreset preset) :
-  mLevelCount(350),
-  mColorInterpolation(ciRGB),
-  mPeriodic(false),
-  mColorBufferInvalidated(true)
-{
-  mColorBuffer.fill(qRgb(0, 0, 0), mLevelCount);
-  loadPreset(preset);
-}
-
-/* undocumented operator */
-bool QCPColorGradient::operator==(const QCPColorGradient &other) const
+bool QCustomPlot::savePngAsync(const QString &fileName, int width, int height, double scale, int quality)
 {
-  return ((other.mLevelCount == this->mLevelCount) &&
-          (other.mColorInterpolation == this->mColorInterpolation) &&
-          (other.mPeriodic == this->mPeriodic) &&
-          (other.mColorStops == this->mColorStops));
+  return saveRasteredAsync(fileName, width, height, scale, "PNG", quality);
 }
 
 /*!
-  Sets the number of discretization levels of the color gradient to \a n. The default is 350 which
-  is typically enough to create a smooth appearance.
+  Saves the plot to a rastered image file \a fileName in the image format \a format, like \ref
+  saveRastered, but without blocking the GUI thread while the image is rasterized and encoded.
   
-  \image html QCPColorGradient-levelcount.png
+  The plot is laid out at the export size and its drawing commands are recorded into a QPicture.
+  Rasterizing this snapshot at the requested size and \a scale, as well as compressing it to the
+  image file, is then done by a \ref QCPExportJob on a worker thread. Both usually take much
+  longer than recording the drawing commands, especially for large exports.
+  
+  When the file was written, the \ref exportFinished signal is emitted. Returns true if the export
+  job was started successfully.
+  
+  \note Pixmaps that are part of the plot (e.g. a background pixmap, \ref QCPItemPixmap or \ref
+  QCPScatterStyle::ssPixmap) are replayed on the worker thread, too. This requires a platform that
+  supports pixmaps outside the GUI thread, which is the case for all raster based platforms.
+  
+  \see savePngAsync, savePdfAsync, pendingExportCount
 */
-void QCPColorGradient::setLevelCount(int n)
+bool QCustomPlot::saveRasteredAsync(const QString &fileName, int width, int height, double scale, const char *format, int quality)
+{
+  int newWidth, newHeight;
+  if (width == 0 || height == 0)
+  {
+    newWidth = this->width();
+    newHeight = this->height();
+  } else
+  {
+    newWidth = width;
+    newHeight = height;
+  }
+  
+  QCPPainter::PainterModes modes = QCPPainter::pmNoCaching;
+  if (!qFuzzyCompare(scale, 1.0) && scale > 1.0) // for scale < 1 we always want cosmetic pens where possible, because else lines might disappear for very small scales
+    modes |= QCPPainter::pmNonCosmetic;
+  // solid backgrounds are filled by the export job, only patterned brushes need to be part of the recording:
+  QBrush background(Qt::NoBrush);
+  if (mBackgroundBrush.style() != Qt::SolidPattern && mBackgroundBrush.style() != Qt::NoBrush)
+    background = mBackgroundBrush;
+  
+  QPicture picture;
+  if (!recordPicture(&picture, newWidth, newHeight, modes, background))
+    return false;
+  QCPExportJob *job = new QCPExportJob(picture, QSize(newWidth, newHeight), fileName);
+  job->setRasteredOutput(format, scale, quality, mBackgroundBrush.style() == Qt::SolidPattern ? mBackgroundBrush.color() : QColor(Qt::transparent));
+  startExportJob(job);
+  return true;
+}
+
+/*! \internal
+  
+  Lays out the plot with a viewport of \a width and \a height and records the complete drawing into
+  \a picture, using a QCPPainter with the specified \a modes. If \a background isn't
+  Qt::NoBrush, the viewport is filled with it before the plot is drawn.
+  
+  Since the recorded picture is independent of the plot, it may be replayed on any thread. This is
+  the snapshot that is passed to a \ref QCPExportJob by the asynchronous export functions.
+  
+  Returns false if the painter couldn't be activated on \a picture.
+*/
+bool QCustomPlot::recordPicture(QPicture *picture, int width, int height, const QCPPainter::PainterModes &modes, const QBrush &background)
+{
+  // this method is somewhat similar to toPainter. Change something here, and a change in toPainter might be necessary, too.
+  QCPPainter painter;
+  if (!painter.begin(picture))
+  {
+    qDebug() << Q_FUNC_INFO << "Couldn't activate painter on picture";
+    return false;
+  }
+  QRect oldViewport = viewport();
+  setViewport(QRect(0, 0, width, height));
+  painter.setModes(modes | QCPPainter::pmNoCaching); // cached label pixmaps must not end up in a picture that is replayed on another thread
+  if (background.style() != Qt::NoBrush)
+    painter.fillRect(mViewport, background);
+  draw(&painter);
+  setViewport(oldViewport);
+  painter.end();
+  return true;
+}
+
+/*! \internal
+  
+  Takes ownership of \a job and starts it on a worker thread with low priority, so it doesn't
+  compete with the GUI thread. When the job reports back, \ref exportJobFinished cleans it up.
+*/
+void QCustomPlot::startExportJob(QCPExportJob *job)
+{
+  connect(job, SIGNAL(exportFinished(QString,bool)), this, SLOT(exportJobFinished(QString,bool)));
+  mExportJobs.append(job);
+  job->start(QThread::LowPriority);
+}
+
+/*! \internal
+  
+  Called (queued, in the GUI thread) when an export job has written its file. Deletes the job and
+  forwards the result via the \ref exportFinished signal.
+*/
+void QCustomPlot::exportJobFinished(const QString &fileName, bool success)
+{
+  if (QCPExportJob *job = qobject_cast<QCPExportJob*>(sender()))
+  {
+    mExportJobs.removeOne(job);
+    job->wait(); // the signal is emitted at the very end of QCPExportJob::run, so this returns immediately
+    job->deleteLater();
+  }
+  emit exportFinished(fileName, success);
+}
+
+/*! \internal
+  
+  Requests a replot in response to an interactive change of the plot, e.g. a range drag or zoom
+  with the mouse. The replot is queued (see \ref setQueuedReplotInterval), so consecutive changes
+  are coalesced into one replot.
+  
+  If progressive refinement is enabled (\ref setProgressiveRefinement), the replot is rendered as
+  a reduced quality preview and the refining replot is (re)scheduled.
+*/
+void QCustomPlot::interactionReplot()
+{
+  if (mProgressiveRefinement)
+  {
+    mInteractionPreview = true;
+    mRefinementTimer->start(mRefinementDelay);
+  }
+  replot(rpQueuedReplot);
+}
+
+/*! \internal
+  
+  Ends the reduced quality preview started by \ref interactionReplot and replots the plot in full
+  quality. Called when no interaction happened for the refinement delay (\ref setRefinementDelay).
+*/
+void QCustomPlot::refineReplot()
+{
+  mRefinementTimer->stop();
+  if (!mInteractionPreview)
+    return;
+  mInteractionPreview = false;
+  replot();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPExportJob
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPExportJob
+  \brief A worker thread that writes a recorded plot snapshot to a file
+  
+  Export jobs are created by the asynchronous export functions of QCustomPlot (\ref
+  QCustomPlot::savePdfAsync, \ref QCustomPlot::savePngAsync and \ref
+  QCustomPlot::saveRasteredAsync). They hold a QPicture with the recorded drawing commands of the
+  plot, so while the job is running, it never accesses the QCustomPlot or any of its layerables.
+  Rasterizing the picture into a QImage (or replaying it into a PDF) and encoding the file thus
+  happens completely on the worker thread.
+  
+  When the file was written, the job emits \ref exportFinished. Normally there is no need to
+  create export jobs manually, QCustomPlot manages their lifetime.
+*/
+
+/* start of documentation of signals */
+
+/*! \fn void QCPExportJob::exportFinished(const QString &fileName, bool success)
+  
+  This signal is emitted from the worker thread when the job has finished writing \a fileName.
+  \a success tells whether the file was written successfully.
+*/
+
+/* end of documentation of signals */
+
+/*!
+  Creates an export job that writes \a picture to \a fileName. \a size is the viewport size the
+  picture was recorded with.
+  
+  The job is configured for PNG output with default settings. Use \ref setRasteredOutput or \ref
+  setPdfOutput to change this before starting the job.
+*/
+QCPExportJob::QCPExportJob(const QPicture &picture, const QSize &size, const QString &fileName, QObject *parent) :
+  QThread(parent),
+  mPicture(picture),
+  mSize(size),
+  mFileName(fileName),
+  mOutputType(otRastered),
+  mFormat("PNG"),
+  mScale(1.0),
+  mQuality(-1),
+  mFillColor(Qt::white),
+  mPdfResolution(96)
+{
+}
+
+QCPExportJob::~QCPExportJob()
+{
+  wait();
+}
+
+/*!
+  Configures the job to write a rastered image in the format \a format. The recorded picture is
+  scaled with \a scale (a picture of width 100 and scale 2.0 lead to an image with width 200).
+  Before the picture is drawn, the image is filled with \a fillColor, which may be transparent.
+  
+  \a quality is passed on to QImage::save.
+*/
+void QCPExportJob::setRasteredOutput(const char *format, double scale, int quality, const QColor &fillColor)
+{
+  mOutputType = otRastered;
+  mFormat = QByteArray(format);
+  mScale = scale;
+  mQuality = quality;
+  mFillColor = fillColor;
+}
+
+/*!
+  Configures the job to write a PDF file. \a pdfCreator and \a pdfTitle are set as metadata of
+  the document. \a resolution should be the logical resolution of the screen the plot is shown on,
+  so the PDF output looks like the on-screen plot (the resolution is queried in the GUI thread,
+  because the worker thread shouldn't access the screen).
+*/
+void QCPExportJob::setPdfOutput(const QString &pdfCreator, const QString &pdfTitle, int resolution)
+{
+  mOutputType = otPdf;
+  mPdfCreator = pdfCreator;
+  mPdfTitle = pdfTitle;
+  mPdfResolution = resolution;
+}
+
+/*! \internal
+  
+  Writes the file according to the configured output type and emits \ref exportFinished.
+*/
+void QCPExportJob::run()
+{
+  bool success = false;
+  switch (mOutputType)
+  {
+    case otRastered: success = writeRastered(); break;
+    case otPdf: success = writePdf(); break;
+  }
+  emit exportFinished(mFileName, success);
+}
+
+/*! \internal
+  
+  Replays the recorded picture into a QImage and saves it. QImage (unlike QPixmap) may be painted
+  on in any thread.
+*/
+bool QCPExportJob::writeRastered()
+{
+  int scaledWidth = qRound(mScale*mSize.width());
+  int scaledHeight = qRound(mScale*mSize.height());
+  if (scaledWidth <= 0 || scaledHeight <= 0)
+    return false;
+  
+  QImage image(scaledWidth, scaledHeight, QImage::Format_ARGB32_Premultiplied);
+  image.fill(0);
+  QPainter painter;
+  if (!painter.begin(&image))
+    return false;
+  if (mFillColor.alpha() > 0)
+    painter.fillRect(image.rect(), mFillColor);
+  if (!qFuzzyCompare(mScale, 1.0))
+    painter.scale(mScale, mScale);
+  painter.drawPicture(0, 0, mPicture);
+  painter.end();
+  return image.save(mFileName, mFormat.constData(), mQuality);
+}
+
+/*! \internal
+  
+  Replays the recorded picture into a PDF file. The page setup is the same as in \ref
+  QCustomPlot::savePdf. Painting on a QPrinter with PDF output format is supported outside the
+  GUI thread.
+*/
+bool QCPExportJob::writePdf()
+{
+#ifdef QT_NO_PRINTER
+  return false;
+#else
+  QPrinter printer(QPrinter::HighResolution);
+  printer.setResolution(mPdfResolution);
+  printer.setOutputFileName(mFileName);
+  printer.setOutputFormat(QPrinter::PdfFormat);
+  printer.setColorMode(QPrinter::Color);
+  printer.printEngine()->setProperty(QPrintEngine::PPK_Creator, mPdfCreator);
+  printer.printEngine()->setProperty(QPrintEngine::PPK_DocumentName, mPdfTitle);
+#if QT_VERSION < QT_VERSION_CHECK(5, 3, 0)
+  printer.setFullPage(true);
+  printer.setPaperSize(mSize, QPrinter::DevicePixel);
+#else
+  QPageLayout pageLayout;
+  pageLayout.setMode(QPageLayout::FullPageMode);
+  pageLayout.setOrientation(QPageLayout::Portrait);
+  pageLayout.setMargins(QMarginsF(0, 0, 0, 0));
+  pageLayout.setPageSize(QPageSize(mSize, QPageSize::Point, QString(), QPageSize::ExactMatch));
+  printer.setPageLayout(pageLayout);
+#endif
+  QPainter painter;
+  if (!painter.begin(&printer))
+    return false;
+  painter.setWindow(QRect(QPoint(0, 0), mSize));
+  painter.drawPicture(0, 0, mPicture);
+  painter.end();
+  return true;
+#endif // QT_NO_PRINTER
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPColorGradient
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPColorGradient
+  \brief Defines a color gradient for use with e.g. \ref QCPColorMap
+  
+  This class describes a color gradient which can be used to encode data with color. For example,
+  QCPColorMap and QCPColorScale have \ref QCPColorMap::setGradient "setGradient" methods which
+  take an instance of this class. Colors are set with \ref setColorStopAt(double position, const QColor &color)
+  with a \a position from 0 to 1. In between these defined color positions, the
+  color will be interpolated linearly either in RGB or HSV space, see \ref setColorInterpolation.
+
+  Alternatively, load one of the preset color gradients shown in the image below, with \ref
+  loadPreset, or by directly specifying the preset in the constructor.
+  
+  \image html QCPColorGradient.png
+  
+  The fact that the \ref QCPColorGradient(GradientPreset preset) constructor allows directly
+  converting a \ref GradientPreset to a QCPColorGradient, you can also directly pass \ref
+  GradientPreset to all the \a setGradient methods, e.g.:
+  \snippet documentation/doc-code-snippets/mainwindow.cpp qcpcolorgradient-setgradient
+  
+  The total number of levels used in the gradient can be set with \ref setLevelCount. Whether the
+  color gradient shall be applied periodically (wrapping around) to data values that lie outside
+  the data range specified on the plottable instance can be controlled with \ref setPeriodic.
+*/
+
+/*!
+  Constructs a new QCPColorGradient initialized with the colors and color interpolation according
+  to \a preset.
+  
+  The color level count is initialized to 350.
+*/
+QCPColorGradient::QCPColorGradient(GradientPreset preset) :
+  mLevelCount(350),
+  mColorInterpolation(ciRGB),
+  mPeriodic(false),
+  mColorBufferInvalidated(true)
+{
+  mColorBuffer.fill(qRgb(0, 0, 0), mLevelCount);
+  loadPreset(preset);
+}
+
+/* undocumented operator */
+bool QCPColorGradient::operator==(const QCPColorGradient &other) const
+{
+  return ((other.mLevelCount == this->mLevelCount) &&
+          (other.mColorInterpolation == this->mColorInterpolation) &&
+          (other.mPeriodic == this->mPeriodic) &&
+          (other.mColorStops == this->mColorStops));
+}
+
+/*!
+  Sets the number of discretization levels of the color gradient to \a n. The default is 350 which
+  is typically enough to create a smooth appearance.
+  
+  \image html QCPColorGradient-levelcount.png
+*/
+void QCPColorGradient::setLevelCount(int n)
 {
   if (n < 2)
   {
@@ -12548,7 +13772,7 @@ void QCPAxisRect::mouseMoveEvent(QMouseEvent *event)
     {
       if (mParentPlot->noAntialiasingOnDrag())
         mParentPlot->setNotAntialiasedElements(QCP::aeAll);
-      mParentPlot->replot();
+      mParentPlot->interactionReplot();
     }
   }
 }
@@ -12563,6 +13787,8 @@ void QCPAxisRect::mouseReleaseEvent(QMouseEvent *event)
     mParentPlot->setAntialiasedElements(mAADragBackup);
     mParentPlot->setNotAntialiasedElements(mNotAADragBackup);
   }
+  if (mParentPlot->interactionPreview()) // drag has ended, don't wait for the refinement delay
+    mParentPlot->refineReplot();
 }
 
 /*! \internal
@@ -12600,7 +13826,7 @@ void QCPAxisRect::wheelEvent(QWheelEvent *event)
         if (mRangeZoomVertAxis.data())
           mRangeZoomVertAxis.data()->scaleRange(factor, mRangeZoomVertAxis.data()->pixelToCoord(event->pos().y()));
       }
-      mParentPlot->replot();
+      mParentPlot->interactionReplot();
     }
   }
 }
@@ -12669,6 +13895,8 @@ QCPAbstractLegendItem::QCPAbstractLegendItem(QCPLegend *parent) :
 */
 void QCPAbstractLegendItem::setFont(const QFont &font)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   mFont = font;
 }
 
@@ -12690,6 +13918,8 @@ void QCPAbstractLegendItem::setTextColor(const QColor &color)
 */
 void QCPAbstractLegendItem::setSelectedFont(const QFont &font)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   mSelectedFont = font;
 }
 
@@ -12728,6 +13958,8 @@ void QCPAbstractLegendItem::setSelectable(bool selectable)
 */
 void QCPAbstractLegendItem::setSelected(bool selected)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   if (mSelected != selected)
   {
     mSelected = selected;
@@ -13030,6 +14262,8 @@ void QCPLegend::setBrush(const QBrush &brush)
 */
 void QCPLegend::setFont(const QFont &font)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   mFont = font;
   for (int i=0; i<itemCount(); ++i)
   {
@@ -13063,6 +14297,8 @@ void QCPLegend::setTextColor(const QColor &color)
 */
 void QCPLegend::setIconSize(const QSize &size)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   mIconSize = size;
 }
 
@@ -13081,6 +14317,8 @@ void QCPLegend::setIconSize(int width, int height)
 */
 void QCPLegend::setIconTextPadding(int padding)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   mIconTextPadding = padding;
 }
 
@@ -13137,6 +14375,8 @@ void QCPLegend::setSelectableParts(const SelectableParts &selectable)
 */
 void QCPLegend::setSelectedParts(const SelectableParts &selected)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   SelectableParts newSelected = selected;
   mSelectedParts = this->selectedParts(); // update mSelectedParts in case item selection changed
 
@@ -13201,6 +14441,8 @@ void QCPLegend::setSelectedBrush(const QBrush &brush)
 */
 void QCPLegend::setSelectedFont(const QFont &font)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   mSelectedFont = font;
   for (int i=0; i<itemCount(); ++i)
   {
@@ -13557,6 +14799,8 @@ QCPPlotTitle::QCPPlotTitle(QCustomPlot *parentPlot, const QString &text) :
 */
 void QCPPlotTitle::setText(const QString &text)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   mText = text;
 }
 
@@ -13567,6 +14811,8 @@ void QCPPlotTitle::setText(const QString &text)
 */
 void QCPPlotTitle::setFont(const QFont &font)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   mFont = font;
 }
 
@@ -13587,6 +14833,8 @@ void QCPPlotTitle::setTextColor(const QColor &color)
 */
 void QCPPlotTitle::setSelectedFont(const QFont &font)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   mSelectedFont = font;
 }
 
@@ -13624,6 +14872,8 @@ void QCPPlotTitle::setSelectable(bool selectable)
 */
 void QCPPlotTitle::setSelected(bool selected)
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   if (mSelected != selected)
   {
     mSelected = selected;
@@ -14421,50 +15671,637 @@ QCPData::QCPData(double key, double value) :
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// QCPGraph
+//////////////////// QCPSegmentIndexPrivate
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-/*! \class QCPGraph
-  \brief A plottable representing a graph in a plot.
-
-  \image html QCPGraph.png
-  
-  Usually QCustomPlot creates graphs internally via QCustomPlot::addGraph and the resulting
-  instance is accessed via QCustomPlot::graph.
-
-  To plot data, assign it with the \ref setData or \ref addData functions. Alternatively, you can
-  also access and modify the graph's data via the \ref data method, which returns a pointer to the
-  internal \ref QCPDataMap.
-  
-  Graphs are used to display single-valued data. Single-valued means that there should only be one
-  data point per unique key coordinate. In other words, the graph can't have \a loops. If you do
-  want to plot non-single-valued curves, rather use the QCPCurve plottable.
-  
-  Gaps in the graph line can be created by adding data points with NaN as value
-  (<tt>qQNaN()</tt> or <tt>std::numeric_limits<double>::quiet_NaN()</tt>) in between the two data points that shall be
-  separated.
-  
-  \section appearance Changing the appearance
-  
-  The appearance of the graph is mainly determined by the line style, scatter style, brush and pen
-  of the graph (\ref setLineStyle, \ref setScatterStyle, \ref setBrush, \ref setPen).
+/*! \class QCPSegmentIndexPrivate
+  \internal
+  \brief A uniform pixel grid over the line segments or points of a plottable, used for fast hit testing
   
-  \subsection filling Filling under or between graphs
+  Plottables pass the pixel coordinates they prepared for drawing to the index (\ref setPoints).
+  On the first hit test, \ref distance sets up the grid, and from then on only needs to look at the
+  grid cells around the tested position, instead of calculating the distance to every segment of
+  the plottable.
   
-  QCPGraph knows two types of fills: Normal graph fills towards the zero-value-line parallel to
-  the key axis of the graph, and fills between two graphs, called channel fills. To enable a fill,
-  just set a brush with \ref setBrush which is neither Qt::NoBrush nor fully transparent.
+  Each item (segment or point) is registered in all cells its bounding box overlaps. Items that
+  lie partially or completely outside the axis rect are registered in the nearest border cells, so
+  \ref distance always returns the exact minimum distance, like a linear scan would.
   
-  By default, a normal fill towards the zero-value-line will be drawn. To set up a channel fill
-  between this graph and another one, call \ref setChannelFillGraph with the other graph as
-  parameter.
-
-  \see QCustomPlot::addGraph, QCustomPlot::graph
+  The \ref Stamp passed to \ref setPoints describes the state the pixel coordinates were calculated
+  for. Plottables compare it with their current state (\ref isValid) to know when the index must be
+  rebuilt.
 */
 
-/* start of documentation of inline functions */
+/*!
+  Creates an empty, invalid index.
+*/
+QCPSegmentIndexPrivate::QCPSegmentIndexPrivate() :
+  mGeometry(gPoints),
+  mValid(false),
+  mGridBuilt(false),
+  mCellSize(8),
+  mColumns(0),
+  mRows(0)
+{
+}
 
-/*! \fn QCPDataMap *QCPGraph::data() const
+/*!
+  Sets the pixel coordinates \a points of the index, which form items as defined by \a geometry.
+  The index is valid for \a stamp afterwards.
+  
+  This is cheap (the points are implicitly shared), so plottables can call it on every replot with
+  the geometry they just drew. The grid is only set up by the first call to \ref distance.
+  
+  Points with NaN coordinates are gaps and are never the nearest point.
+*/
+void QCPSegmentIndexPrivate::setPoints(const QVector<QPointF> &points, Geometry geometry, const Stamp &stamp)
+{
+  mPoints = points;
+  mGeometry = mPoints.size() == 1 ? gPoints : geometry; // single point has no segments, so hit test the point itself
+  mStamp = stamp;
+  mValid = true;
+  mGridBuilt = false;
+  mColumns = 0;
+  mRows = 0;
+  mCellStart.clear();
+  mCellItems.clear();
+}
+
+/*! \internal
+  
+  Sets up the grid and registers all items in the cells they cover. For small numbers of items, no
+  grid is set up, and \ref distance scans the items directly.
+*/
+void QCPSegmentIndexPrivate::buildGrid()
+{
+  mGridBuilt = true;
+  const int count = itemCount();
+  const Stamp &stamp = mStamp;
+  if (count < 64 || stamp.axisRect.isEmpty()) // a linear scan is cheaper than setting up the grid
+    return;
+  
+  // choose cell size such that long segments (e.g. noisy data without adaptive sampling) don't cause excessive registrations:
+  mCellSize = 8;
+  QVector<int> cellCount;
+  while (true)
+  {
+    mColumns = (stamp.axisRect.width()+mCellSize-1)/mCellSize;
+    mRows = (stamp.axisRect.height()+mCellSize-1)/mCellSize;
+    cellCount.fill(0, mColumns*mRows+1);
+    qint64 registrations = 0;
+    int left, top, right, bottom;
+    for (int i=0; i<count; ++i)
+    {
+      if (!itemCells(i, left, top, right, bottom))
+        continue;
+      for (int row=top; row<=bottom; ++row)
+        for (int col=left; col<=right; ++col)
+          ++cellCount[row*mColumns+col];
+      registrations += (qint64)(right-left+1)*(bottom-top+1);
+    }
+    if (registrations <= qMax(16*count, 1<<20) || mCellSize >= 256)
+      break;
+    mCellSize *= 2;
+  }
+  
+  // convert counts to start offsets, then distribute items into their cells:
+  mCellStart.resize(mColumns*mRows+1);
+  int offset = 0;
+  for (int cell=0; cell<mColumns*mRows; ++cell)
+  {
+    mCellStart[cell] = offset;
+    offset += cellCount.at(cell);
+  }
+  mCellStart[mColumns*mRows] = offset;
+  mCellItems.resize(offset);
+  QVector<int> cellFill = mCellStart;
+  int left, top, right, bottom;
+  for (int i=0; i<count; ++i)
+  {
+    if (!itemCells(i, left, top, right, bottom))
+      continue;
+    for (int row=top; row<=bottom; ++row)
+      for (int col=left; col<=right; ++col)
+        mCellItems[cellFill[row*mColumns+col]++] = i;
+  }
+}
+
+/*!
+  Releases the stored points and grid and marks the index as invalid.
+*/
+void QCPSegmentIndexPrivate::clear()
+{
+  mPoints.clear();
+  mCellStart.clear();
+  mCellItems.clear();
+  mColumns = 0;
+  mRows = 0;
+  mValid = false;
+  mGridBuilt = false;
+}
+
+/*!
+  Returns the minimum distance in pixels between \a pos and the items of the index, or -1 if the
+  index contains no (non-NaN) items.
+  
+  The grid cells are searched in rings of increasing distance around \a pos. The search stops as
+  soon as the nearest item found so far is closer than any item in the unsearched cells can be.
+*/
+double QCPSegmentIndexPrivate::distance(const QPointF &pos)
+{
+  if (!mGridBuilt)
+    buildGrid();
+  double minDistSqr = std::numeric_limits<double>::max();
+  if (mColumns == 0 || !mStamp.axisRect.contains(pos.toPoint())) // no grid, or outside of it where the ring search isn't exact, scan all items
+  {
+    const int count = itemCount();
+    for (int i=0; i<count; ++i)
+    {
+      double currentDistSqr = itemDistSqr(i, pos);
+      if (currentDistSqr < minDistSqr)
+        minDistSqr = currentDistSqr;
+    }
+  } else
+  {
+    const int posCol = cellIndex(pos.x(), mStamp.axisRect.left(), mColumns);
+    const int posRow = cellIndex(pos.y(), mStamp.axisRect.top(), mRows);
+    const int maxRing = qMax(qMax(posCol, mColumns-1-posCol), qMax(posRow, mRows-1-posRow));
+    for (int ring=0; ring<=maxRing; ++ring)
+    {
+      for (int row=qMax(0, posRow-ring); row<=qMin(mRows-1, posRow+ring); ++row)
+      {
+        const bool fullRow = row == posRow-ring || row == posRow+ring;
+        const int colStep = fullRow ? 1 : 2*ring; // inner rows of the ring only have the two outer cells
+        for (int col=posCol-ring; col<=posCol+ring; col+=qMax(1, colStep))
+        {
+          if (col < 0 || col >= mColumns)
+            continue;
+          const int cell = row*mColumns+col;
+          for (int k=mCellStart.at(cell); k<mCellStart.at(cell+1); ++k)
+          {
+            double currentDistSqr = itemDistSqr(mCellItems.at(k), pos);
+            if (currentDistSqr < minDistSqr)
+              minDistSqr = currentDistSqr;
+          }
+        }
+      }
+      // all items closer than ring*mCellSize pixels have now been visited:
+      const double searchedRadius = ring*mCellSize;
+      if (minDistSqr <= searchedRadius*searchedRadius)
+        break;
+    }
+  }
+  if (minDistSqr == std::numeric_limits<double>::max())
+    return -1;
+  return qSqrt(minDistSqr);
+}
+
+/*! \internal
+  
+  Returns the number of items (points or line segments) formed by the stored points.
+*/
+int QCPSegmentIndexPrivate::itemCount() const
+{
+  switch (mGeometry)
+  {
+    case gPoints: return mPoints.size();
+    case gPolyline: return qMax(0, mPoints.size()-1);
+    case gLinePairs: return mPoints.size()/2;
+  }
+  return 0;
+}
+
+/*! \internal
+  
+  Calculates the range of grid cells covered by the bounding box of \a item, clamped to the grid.
+  Returns false if the item contains NaN coordinates and thus isn't drawn.
+*/
+bool QCPSegmentIndexPrivate::itemCells(int item, int &cellLeft, int &cellTop, int &cellRight, int &cellBottom) const
+{
+  const QPointF &a = mPoints.at(mGeometry == gLinePairs ? 2*item : item);
+  const QPointF &b = mPoints.at(mGeometry == gPoints ? item : (mGeometry == gLinePairs ? 2*item+1 : item+1));
+  if (qIsNaN(a.x()) || qIsNaN(a.y()) || qIsNaN(b.x()) || qIsNaN(b.y()))
+    return false;
+  cellLeft = cellIndex(qMin(a.x(), b.x()), mStamp.axisRect.left(), mColumns);
+  cellRight = cellIndex(qMax(a.x(), b.x()), mStamp.axisRect.left(), mColumns);
+  cellTop = cellIndex(qMin(a.y(), b.y()), mStamp.axisRect.top(), mRows);
+  cellBottom = cellIndex(qMax(a.y(), b.y()), mStamp.axisRect.top(), mRows);
+  return true;
+}
+
+/*! \internal
+  
+  Returns the squared distance between \a pos and \a item. For items with NaN coordinates, returns
+  NaN, which never compares as a new minimum.
+*/
+double QCPSegmentIndexPrivate::itemDistSqr(int item, const QPointF &pos) const
+{
+  QVector2D p(pos);
+  if (mGeometry == gPoints)
+    return (QVector2D(mPoints.at(item))-p).lengthSquared();
+  
+  const int first = mGeometry == gLinePairs ? 2*item : item;
+  QVector2D a(mPoints.at(first));
+  QVector2D b(mPoints.at(first+1));
+  QVector2D v(b-a);
+  double vLengthSqr = v.lengthSquared();
+  if (!qFuzzyIsNull(vLengthSqr))
+  {
+    double mu = QVector2D::dotProduct(p-a, v)/vLengthSqr;
+    if (mu < 0)
+      return (a-p).lengthSquared();
+    else if (mu > 1)
+      return (b-p).lengthSquared();
+    else
+      return ((a + mu*v)-p).lengthSquared();
+  } else
+    return (a-p).lengthSquared();
+}
+
+/*! \internal
+  
+  Returns the index of the grid cell (column or row) containing the pixel coordinate \a coord,
+  clamped to the valid range \a cellCount. \a origin is the pixel coordinate of the grid's left or
+  top border.
+*/
+int QCPSegmentIndexPrivate::cellIndex(double coord, int origin, int cellCount) const
+{
+  return (int)qBound(0.0, floor((coord-origin)/(double)mCellSize), cellCount-1.0); // bound as double, pixel coordinates far outside the axis rect may exceed the int range
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPCompactDataSeries
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPCompactDataSeries
+  \brief Compact storage for long key/value histories, which feeds the visible part into a QCPGraph
+  
+  A QCPGraph stores each data point as a \ref QCPData (key, value and four error values) in a
+  \ref QCPDataMap, i.e. more than 80 bytes per point including the map overhead. For long
+  recordings without error bars, most of that is wasted. QCPCompactDataSeries keeps keys and values
+  in contiguous arrays, in one of the formats defined by \ref StorageMode:
+  
+  \li \ref smDouble stores both as double, with full precision (16 bytes per point).
+  \li \ref smFloat stores the key as float offset from the first key, and the value as float (8 bytes
+  per point). The key offset has about 7 significant digits, so the key resolution degrades for
+  very long series.
+  \li \ref smQuantized stores the key as 32 bit integer multiple of \ref keyResolution from the first
+  key, and the value as 16 bit integer multiple of \ref valueResolution (6 bytes per point). For
+  example, a distance sensor delivering centimetres at one sample per key unit uses a value
+  resolution of 1 (or 0.01 with metres), and a key resolution of 1. Values outside the 16 bit range
+  are clamped, NaN values are preserved.
+  
+  The keys must be appended in ascending order. Points are removed from the front with \ref
+  removeFirst, which only advances an offset into the arrays and occasionally compacts them, so the
+  series can also serve as a sliding window.
+  
+  Typically, the application appends all samples to the series and, before a replot, passes only
+  the visible key range to the graph with \ref setGraphData, which also reduces the points to the
+  pixel resolution of the key axis:
+  \code
+  history.append(key, value);
+  history.setGraphData(customPlot->graph(0), xAxis->range().lower, xAxis->range().upper);
+  customPlot->replot();
+  \endcode
+*/
+
+/*!
+  Creates an empty series with the specified storage \a mode. \a keyResolution and \a
+  valueResolution are only used in \ref smQuantized mode, see the class documentation.
+*/
+QCPCompactDataSeries::QCPCompactDataSeries(StorageMode mode, double keyResolution, double valueResolution) :
+  mMode(mode),
+  mKeyResolution(keyResolution > 0 ? keyResolution : 1.0),
+  mValueResolution(valueResolution > 0 ? valueResolution : 1.0),
+  mBaseKey(0),
+  mFirst(0)
+{
+}
+
+/*!
+  Returns the number of data points in the series.
+*/
+int QCPCompactDataSeries::size() const
+{
+  switch (mMode)
+  {
+    case smDouble: return mDoubleKeys.size()-mFirst;
+    case smFloat: return mFloatKeys.size()-mFirst;
+    case smQuantized: return mIntKeys.size()-mFirst;
+  }
+  return 0;
+}
+
+/*!
+  Returns the key of the data point at \a index (0 is the oldest point).
+*/
+double QCPCompactDataSeries::key(int index) const
+{
+  switch (mMode)
+  {
+    case smDouble: return mDoubleKeys.at(mFirst+index);
+    case smFloat: return mBaseKey+mFloatKeys.at(mFirst+index);
+    case smQuantized: return mBaseKey+mIntKeys.at(mFirst+index)*mKeyResolution;
+  }
+  return 0;
+}
+
+/*!
+  Returns the value of the data point at \a index (0 is the oldest point).
+*/
+double QCPCompactDataSeries::value(int index) const
+{
+  switch (mMode)
+  {
+    case smDouble: return mDoubleValues.at(mFirst+index);
+    case smFloat: return mFloatValues.at(mFirst+index);
+    case smQuantized:
+    {
+      qint16 quantized = mIntValues.at(mFirst+index);
+      return quantized == std::numeric_limits<qint16>::min() ? std::numeric_limits<double>::quiet_NaN() : quantized*mValueResolution;
+    }
+  }
+  return 0;
+}
+
+/*!
+  Appends a data point with \a key and \a value. \a key must not be smaller than the key of the last
+  point in the series, otherwise the point is ignored.
+*/
+void QCPCompactDataSeries::append(double key, double value)
+{
+  if (!isEmpty() && key < this->key(size()-1))
+  {
+    qDebug() << Q_FUNC_INFO << "keys must be appended in ascending order:" << key;
+    return;
+  }
+  if (isEmpty())
+  {
+    clear(); // also releases the space of points removed from the front
+    mBaseKey = key;
+  }
+  switch (mMode)
+  {
+    case smDouble:
+    {
+      mDoubleKeys.append(key);
+      mDoubleValues.append(value);
+      break;
+    }
+    case smFloat:
+    {
+      mFloatKeys.append(float(key-mBaseKey));
+      mFloatValues.append(float(value));
+      break;
+    }
+    case smQuantized:
+    {
+      double keySteps = qRound64((key-mBaseKey)/mKeyResolution);
+      if (keySteps > std::numeric_limits<qint32>::max())
+      {
+        qDebug() << Q_FUNC_INFO << "key exceeds the range of quantized keys, increase the key resolution:" << key;
+        return;
+      }
+      mIntKeys.append(qint32(keySteps));
+      if (qIsNaN(value))
+        mIntValues.append(std::numeric_limits<qint16>::min()); // reserved for NaN
+      else
+        mIntValues.append(qint16(qBound(-32767.0, double(qRound64(value/mValueResolution)), 32767.0)));
+      break;
+    }
+  }
+}
+
+/*! \overload
+  
+  Appends \a count data points from the arrays \a keys and \a values.
+*/
+void QCPCompactDataSeries::append(const double *keys, const double *values, int count)
+{
+  for (int i=0; i<count; ++i)
+    append(keys[i], values[i]);
+}
+
+/*!
+  Removes the \a count oldest data points. This only advances an offset into the storage, which is
+  compacted with one move once more than half of it is unused. Averaged over many calls, the cost
+  per removed point is constant.
+*/
+void QCPCompactDataSeries::removeFirst(int count)
+{
+  mFirst += qBound(0, count, size());
+  const int total = mFirst+size();
+  if (mFirst > 1024 && mFirst > total/2)
+  {
+    switch (mMode)
+    {
+      case smDouble: mDoubleKeys.remove(0, mFirst); mDoubleValues.remove(0, mFirst); break;
+      case smFloat: mFloatKeys.remove(0, mFirst); mFloatValues.remove(0, mFirst); break;
+      case smQuantized: mIntKeys.remove(0, mFirst); mIntValues.remove(0, mFirst); break;
+    }
+    mFirst = 0;
+  }
+}
+
+/*!
+  Removes all data points.
+*/
+void QCPCompactDataSeries::clear()
+{
+  mDoubleKeys.clear();
+  mDoubleValues.clear();
+  mFloatKeys.clear();
+  mFloatValues.clear();
+  mIntKeys.clear();
+  mIntValues.clear();
+  mFirst = 0;
+  mBaseKey = 0;
+}
+
+/*!
+  Returns the index of the first data point with a key not smaller than \a key, or \ref size if
+  there is none. Uses a binary search.
+*/
+int QCPCompactDataSeries::findBegin(double key) const
+{
+  int lower = 0;
+  int upper = size();
+  while (lower < upper)
+  {
+    int middle = lower+(upper-lower)/2;
+    if (this->key(middle) < key)
+      lower = middle+1;
+    else
+      upper = middle;
+  }
+  return lower;
+}
+
+/*!
+  Replaces the data of \a graph with the data points whose keys lie between \a lowerKey and \a
+  upperKey, plus one point beyond each end, so the graph line reaches the edges of the axis rect.
+  
+  If the range holds more points than the key axis has pixels, the points are reduced to pixel
+  resolution while copying: of all points that fall into the same pixel column of the key axis,
+  only the ones with the minimum and the maximum value are passed, in key order. The pixel columns
+  are determined as if the key axis showed the range from \a lowerKey to \a upperKey. This is the same
+  reduction the graph's adaptive sampling applies when drawing (see \ref
+  QCPGraph::setAdaptiveSampling), so the plot looks the same, but the graph never holds more than
+  two \ref QCPData points per pixel column, no matter how much history is visible. NaN values are
+  always passed, so gaps in the line are preserved.
+  
+  To keep the graph in sync while the user drags or zooms the key axis, call this method whenever
+  the key axis range changes. With Qt 5 and C++11, this can be done with a lambda:
+  \code
+  QObject::connect(customPlot->xAxis, static_cast<void (QCPAxis::*)(const QCPRange&)>(&QCPAxis::rangeChanged),
+                   [&history, graph](const QCPRange &range) { history.setGraphData(graph, range.lower, range.upper); });
+  \endcode
+  To show the complete history, pass the first and last key, e.g. \c key(0) and \c key(size()-1).
+*/
+void QCPCompactDataSeries::setGraphData(QCPGraph *graph, double lowerKey, double upperKey) const
+{
+  if (!graph) { qDebug() << Q_FUNC_INFO << "invalid graph"; return; }
+  int begin = qMax(0, findBegin(lowerKey)-1);
+  int end = qMin(size(), findBegin(upperKey)+1);
+  
+  // determine the pixel resolution of the key axis, zero if it isn't laid out yet:
+  QCPAxis *keyAxis = graph->keyAxis();
+  int columnCount = 0;
+  if (keyAxis && keyAxis->axisRect())
+    columnCount = keyAxis->orientation() == Qt::Horizontal ? keyAxis->axisRect()->width() : keyAxis->axisRect()->height();
+  const bool reduce = columnCount > 0 && end-begin > 2*columnCount && upperKey > lowerKey;
+  // map keys to pixel columns as if the key axis showed lowerKey to upperKey, i.e. the range of the next replot:
+  const bool logKeys = keyAxis && keyAxis->scaleType() == QCPAxis::stLogarithmic && lowerKey > 0;
+  const double columnOrigin = logKeys ? qLn(lowerKey) : lowerKey;
+  const double columnScale = reduce ? columnCount/((logKeys ? qLn(upperKey) : upperKey)-columnOrigin) : 0;
+  
+  QVector<double> keys, values;
+  const int maxCount = reduce ? 2*columnCount+4 : end-begin; // two points per column, plus the points beyond each end
+  keys.reserve(qMax(0, maxCount));
+  values.reserve(qMax(0, maxCount));
+  if (!reduce)
+  {
+    for (int i=begin; i<end; ++i)
+    {
+      keys.append(key(i));
+      values.append(value(i));
+    }
+  } else
+  {
+    int i = begin;
+    while (i < end)
+    {
+      const double firstKey = key(i);
+      const double firstValue = value(i);
+      if (qIsNaN(firstValue))
+      {
+        keys.append(firstKey);
+        values.append(firstValue);
+        ++i;
+        continue;
+      }
+      // collect the extremes of all points in the pixel column of the current point:
+      const double firstColumn = floor(((logKeys ? qLn(qMax(firstKey, lowerKey*1e-9)) : firstKey)-columnOrigin)*columnScale);
+      double minKey = firstKey, minValue = firstValue, maxKey = firstKey, maxValue = firstValue;
+      ++i;
+      while (i < end)
+      {
+        const double currentKey = key(i);
+        if (floor(((logKeys ? qLn(qMax(currentKey, lowerKey*1e-9)) : currentKey)-columnOrigin)*columnScale) != firstColumn)
+          break;
+        const double currentValue = value(i);
+        if (qIsNaN(currentValue))
+          break;
+        if (currentValue < minValue)
+        {
+          minValue = currentValue;
+          minKey = currentKey;
+        } else if (currentValue > maxValue)
+        {
+          maxValue = currentValue;
+          maxKey = currentKey;
+        }
+        ++i;
+      }
+      // emit the extremes in key order, so the line passes them in the right sequence:
+      if (minKey <= maxKey)
+      {
+        keys.append(minKey);
+        values.append(minValue);
+        if (maxKey != minKey)
+        {
+          keys.append(maxKey);
+          values.append(maxValue);
+        }
+      } else
+      {
+        keys.append(maxKey);
+        values.append(maxValue);
+        keys.append(minKey);
+        values.append(minValue);
+      }
+    }
+  }
+  graph->setData(keys.constData(), values.constData(), keys.size());
+}
+
+/*!
+  Returns the approximate number of bytes occupied by the stored data points.
+*/
+qint64 QCPCompactDataSeries::memoryUsage() const
+{
+  return qint64(mDoubleKeys.capacity()+mDoubleValues.capacity())*sizeof(double) +
+         qint64(mFloatKeys.capacity()+mFloatValues.capacity())*sizeof(float) +
+         qint64(mIntKeys.capacity())*sizeof(qint32) + qint64(mIntValues.capacity())*sizeof(qint16);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPGraph
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPGraph
+  \brief A plottable representing a graph in a plot.
+
+  \image html QCPGraph.png
+  
+  Usually QCustomPlot creates graphs internally via QCustomPlot::addGraph and the resulting
+  instance is accessed via QCustomPlot::graph.
+
+  To plot data, assign it with the \ref setData or \ref addData functions. Alternatively, you can
+  also access and modify the graph's data via the \ref data method, which returns a pointer to the
+  internal \ref QCPDataMap.
+  
+  Graphs are used to display single-valued data. Single-valued means that there should only be one
+  data point per unique key coordinate. In other words, the graph can't have \a loops. If you do
+  want to plot non-single-valued curves, rather use the QCPCurve plottable.
+  
+  Gaps in the graph line can be created by adding data points with NaN as value
+  (<tt>qQNaN()</tt> or <tt>std::numeric_limits<double>::quiet_NaN()</tt>) in between the two data points that shall be
+  separated.
+  
+  \section appearance Changing the appearance
+  
+  The appearance of the graph is mainly determined by the line style, scatter style, brush and pen
+  of the graph (\ref setLineStyle, \ref setScatterStyle, \ref setBrush, \ref setPen).
+  
+  \subsection filling Filling under or between graphs
+  
+  QCPGraph knows two types of fills: Normal graph fills towards the zero-value-line parallel to
+  the key axis of the graph, and fills between two graphs, called channel fills. To enable a fill,
+  just set a brush with \ref setBrush which is neither Qt::NoBrush nor fully transparent.
+  
+  By default, a normal fill towards the zero-value-line will be drawn. To set up a channel fill
+  between this graph and another one, call \ref setChannelFillGraph with the other graph as
+  parameter.
+
+  \see QCustomPlot::addGraph, QCustomPlot::graph
+*/
+
+/* start of documentation of inline functions */
+
+/*! \fn QCPDataMap *QCPGraph::data() const
   
   Returns a pointer to the internal data storage of type \ref QCPDataMap. You may use it to
   directly manipulate the data, which may be more convenient and faster than using the regular \ref
@@ -14501,6 +16338,9 @@ QCPGraph::QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   setErrorBarSkipSymbol(true);
   setChannelFillGraph(0);
   setAdaptiveSampling(true);
+  setFastLineRendering(false);
+  setMaxDataCount(0);
+  setMaxKeySpan(0);
 }
 
 QCPGraph::~QCPGraph()
@@ -14517,9 +16357,12 @@ QCPGraph::~QCPGraph()
   
   Alternatively, you can also access and modify the graph's data via the \ref data method, which
   returns a pointer to the internal \ref QCPDataMap.
+  
+  \see setData(const double *keys, const double *values, int count)
 */
 void QCPGraph::setData(QCPDataMap *data, bool copy)
 {
+  ++mDataVersion;
   if (mData == data)
   {
     qDebug() << Q_FUNC_INFO << "The data pointer is already in (and owned by) this plottable" << reinterpret_cast<quintptr>(data);
@@ -14533,7 +16376,32 @@ void QCPGraph::setData(QCPDataMap *data, bool copy)
     delete mData;
     mData = data;
   }
+  applyRetention();
+}
+
+#ifdef Q_COMPILER_RVALUE_REFS
+/*! \overload
+  
+  Replaces the current data with \a data by swapping the map contents, so no data point is copied
+  and no pointer ownership has to be managed. \a data is empty afterwards.
+  
+  This is the preferred way to hand over a data map that was prepared elsewhere, e.g. by a loader
+  thread:
+  \code
+  QCPDataMap loaded = loadRecording(fileName);
+  graph->setData(std::move(loaded));
+  \endcode
+  
+  Only available when the compiler supports rvalue references.
+*/
+void QCPGraph::setData(QCPDataMap &&data)
+{
+  ++mDataVersion;
+  mData->swap(data);
+  data.clear();
+  applyRetention();
 }
+#endif
 
 /*! \overload
   
@@ -14543,16 +16411,24 @@ void QCPGraph::setData(QCPDataMap *data, bool copy)
 */
 void QCPGraph::setData(const QVector<double> &key, const QVector<double> &value)
 {
-  mData->clear();
-  int n = key.size();
-  n = qMin(n, value.size());
-  QCPData newData;
-  for (int i=0; i<n; ++i)
-  {
-    newData.key = key[i];
-    newData.value = value[i];
-    mData->insertMulti(newData.key, newData);
-  }
+  setData(key.constData(), value.constData(), qMin(key.size(), value.size()));
+}
+
+/*! \overload
+  
+  Replaces the current data with \a count points from the arrays \a keys and \a values.
+  
+  The points are built into a new data map in one pass, which the graph then adopts like with
+  \ref setData(QCPDataMap *data, bool copy) with \a copy set to false, so the old data is released
+  at once and nothing is copied twice. If the keys are sorted ascendingly, e.g. when loading a
+  recording, each point is appended at the end without a full key lookup. See \ref addData(const
+  double *keys, const double *values, int count) for details.
+*/
+void QCPGraph::setData(const double *keys, const double *values, int count)
+{
+  QCPDataMap *data = new QCPDataMap;
+  appendToDataMap(data, keys, values, count);
+  setData(data, false);
 }
 
 /*!
@@ -14566,6 +16442,7 @@ void QCPGraph::setData(const QVector<double> &key, const QVector<double> &value)
 */
 void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &valueError)
 {
+  ++mDataVersion;
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -14579,6 +16456,7 @@ void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<doubl
     newData.valueErrorPlus = valueError[i];
     mData->insertMulti(key[i], newData);
   }
+  applyRetention();
 }
 
 /*!
@@ -14592,6 +16470,7 @@ void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<doubl
 */
 void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &valueErrorMinus, const QVector<double> &valueErrorPlus)
 {
+  ++mDataVersion;
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -14606,6 +16485,7 @@ void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<doubl
     newData.valueErrorPlus = valueErrorPlus[i];
     mData->insertMulti(key[i], newData);
   }
+  applyRetention();
 }
 
 /*!
@@ -14619,6 +16499,7 @@ void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<doubl
 */
 void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyError)
 {
+  ++mDataVersion;
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -14632,6 +16513,7 @@ void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double>
     newData.keyErrorPlus = keyError[i];
     mData->insertMulti(key[i], newData);
   }
+  applyRetention();
 }
 
 /*!
@@ -14645,6 +16527,7 @@ void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double>
 */
 void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyErrorMinus, const QVector<double> &keyErrorPlus)
 {
+  ++mDataVersion;
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -14659,6 +16542,7 @@ void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double>
     newData.keyErrorPlus = keyErrorPlus[i];
     mData->insertMulti(key[i], newData);
   }
+  applyRetention();
 }
 
 /*!
@@ -14672,6 +16556,7 @@ void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double>
 */
 void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyError, const QVector<double> &valueError)
 {
+  ++mDataVersion;
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -14688,6 +16573,7 @@ void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double
     newData.valueErrorPlus = valueError[i];
     mData->insertMulti(key[i], newData);
   }
+  applyRetention();
 }
 
 /*!
@@ -14701,6 +16587,7 @@ void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double
 */
 void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyErrorMinus, const QVector<double> &keyErrorPlus, const QVector<double> &valueErrorMinus, const QVector<double> &valueErrorPlus)
 {
+  ++mDataVersion;
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -14719,6 +16606,7 @@ void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double
     newData.valueErrorPlus = valueErrorPlus[i];
     mData->insertMulti(key[i], newData);
   }
+  applyRetention();
 }
 
 
@@ -14731,6 +16619,7 @@ void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double
 void QCPGraph::setLineStyle(LineStyle ls)
 {
   mLineStyle = ls;
+  mHitTestIndex.clear();
 }
 
 /*!
@@ -14742,6 +16631,7 @@ void QCPGraph::setLineStyle(LineStyle ls)
 void QCPGraph::setScatterStyle(const QCPScatterStyle &style)
 {
   mScatterStyle = style;
+  mHitTestIndex.clear();
 }
 
 /*!
@@ -14853,6 +16743,68 @@ void QCPGraph::setChannelFillGraph(QCPGraph *targetGraph)
 void QCPGraph::setAdaptiveSampling(bool enabled)
 {
   mAdaptiveSampling = enabled;
+  mHitTestIndex.clear();
+}
+
+/*!
+  Sets whether the line of this graph may be drawn with a dedicated line rasterizer instead of
+  QPainter's line stroking.
+  
+  When enabled, the line segments are rasterized with an integer Bresenham algorithm directly into
+  the scanlines of an internal image buffer, which is then composited onto the plot with a single
+  image draw call. This bypasses path construction and stroking in the paint engine and
+  significantly speeds up graphs with many visible line segments, e.g. in realtime applications.
+  
+  The fast path is only taken when the result is equivalent to regular drawing, i.e. when the pen
+  used to draw the line is a solid, one pixel wide (or cosmetic) pen, the graph isn't drawn
+  antialiased (see \ref setAntialiased), and the painter isn't in vectorized or non-caching mode
+  (e.g. when exporting to PDF). Otherwise the line is drawn as usual.
+  
+  This setting only affects the line styles that connect points with lines (\ref lsLine and the
+  step styles). Fill, impulses, scatters and error bars are unaffected. The default is false.
+  
+  \see setAdaptiveSampling
+*/
+void QCPGraph::setFastLineRendering(bool enabled)
+{
+  mFastLineRendering = enabled;
+}
+
+/*!
+  Sets the maximum number of data points the graph retains. When data is added or set and the graph
+  holds more points than \a count, the points with the smallest keys are removed. This turns the
+  graph into a sliding window, e.g. for a strip chart that runs indefinitely with constant memory.
+  
+  Points are evicted by erasing from the front of the data map, which needs no key lookup. The cost
+  per added sample therefore doesn't grow with the number of evicted points, but erasing still
+  rebalances the map, which is logarithmic in the number of retained points.
+  
+  Set \a count to 0 (the default) to retain all data.
+  
+  \note Changes made directly to the map returned by \ref data are not checked. The retention is
+  applied on the next call to one of the setData or addData methods.
+  
+  \see setMaxKeySpan
+*/
+void QCPGraph::setMaxDataCount(int count)
+{
+  mMaxDataCount = qMax(0, count);
+  applyRetention();
+}
+
+/*!
+  Sets the maximum key span of the data the graph retains. When data is added or set, all points
+  with keys smaller than the largest key minus \a span are removed. For example, if the keys are
+  seconds, a \a span of 3600 keeps the last hour of data.
+  
+  Set \a span to 0 (the default) to retain all data.
+  
+  \see setMaxDataCount
+*/
+void QCPGraph::setMaxKeySpan(double span)
+{
+  mMaxKeySpan = qMax(0.0, span);
+  applyRetention();
 }
 
 /*!
@@ -14865,7 +16817,9 @@ void QCPGraph::setAdaptiveSampling(bool enabled)
 */
 void QCPGraph::addData(const QCPDataMap &dataMap)
 {
+  ++mDataVersion;
   mData->unite(dataMap);
+  applyRetention();
 }
 
 /*! \overload
@@ -14878,7 +16832,9 @@ void QCPGraph::addData(const QCPDataMap &dataMap)
 */
 void QCPGraph::addData(const QCPData &data)
 {
+  ++mDataVersion;
   mData->insertMulti(data.key, data);
+  applyRetention();
 }
 
 /*! \overload
@@ -14891,10 +16847,12 @@ void QCPGraph::addData(const QCPData &data)
 */
 void QCPGraph::addData(double key, double value)
 {
+  ++mDataVersion;
   QCPData newData;
   newData.key = key;
   newData.value = value;
   mData->insertMulti(newData.key, newData);
+  applyRetention();
 }
 
 /*! \overload
@@ -14907,13 +16865,58 @@ void QCPGraph::addData(double key, double value)
 */
 void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &values)
 {
-  int n = qMin(keys.size(), values.size());
+  addData(keys.constData(), values.constData(), qMin(keys.size(), values.size()));
+}
+
+/*! \overload
+  
+  Adds \a count data points from the arrays \a keys and \a values to the current data. The arrays
+  are only read during the call, the graph doesn't keep references to them.
+  
+  This is the fastest way to add large amounts of data: When the keys are sorted ascendingly and
+  not smaller than the keys already in the graph (e.g. when appending consecutive chunks of a
+  recording or a live stream), each point is inserted with a hint at the end of the data map, which
+  avoids a full key lookup per point. Insertion still rebalances the map, so each point costs
+  logarithmic time in the worst case. Unsorted keys are accepted, too, but are inserted at the
+  regular speed. (The end hint requires Qt 5.1 or newer.)
+  
+  If the graph is empty, the points are built into a new data map which the graph adopts, see \ref
+  setData(const double *keys, const double *values, int count).
+  
+  Note that QCPDataMap is a QMap, so every data point still is a separate map node. To hand over a
+  complete, prepared data map without copying it, use \ref setData(QCPDataMap *data, bool copy)
+  with \a copy set to false, or \ref setData(QCPDataMap &&data).
+*/
+void QCPGraph::addData(const double *keys, const double *values, int count)
+{
+  if (mData->isEmpty())
+  {
+    setData(keys, values, count);
+    return;
+  }
+  ++mDataVersion;
+  appendToDataMap(mData, keys, values, count);
+  applyRetention();
+}
+
+/*! \internal
+  
+  Inserts \a count points from the arrays \a keys and \a values into \a map. Each point is inserted
+  with an end hint, which QMap verifies and which saves the full key lookup when appending sorted
+  keys. (The hint requires Qt 5.1 or newer.)
+*/
+void QCPGraph::appendToDataMap(QCPDataMap *map, const double *keys, const double *values, int count)
+{
   QCPData newData;
-  for (int i=0; i<n; ++i)
+  for (int i=0; i<count; ++i)
   {
     newData.key = keys[i];
     newData.value = values[i];
-    mData->insertMulti(newData.key, newData);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 1, 0)
+    map->insertMulti(map->constEnd(), newData.key, newData);
+#else
+    map->insertMulti(newData.key, newData);
+#endif
   }
 }
 
@@ -14923,6 +16926,7 @@ void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &value
 */
 void QCPGraph::removeDataBefore(double key)
 {
+  ++mDataVersion;
   QCPDataMap::iterator it = mData->begin();
   while (it != mData->end() && it.key() < key)
     it = mData->erase(it);
@@ -14934,6 +16938,7 @@ void QCPGraph::removeDataBefore(double key)
 */
 void QCPGraph::removeDataAfter(double key)
 {
+  ++mDataVersion;
   if (mData->isEmpty()) return;
   QCPDataMap::iterator it = mData->upperBound(key);
   while (it != mData->end())
@@ -14949,6 +16954,7 @@ void QCPGraph::removeDataAfter(double key)
 */
 void QCPGraph::removeData(double fromKey, double toKey)
 {
+  ++mDataVersion;
   if (fromKey >= toKey || mData->isEmpty()) return;
   QCPDataMap::iterator it = mData->upperBound(fromKey);
   QCPDataMap::iterator itEnd = mData->upperBound(toKey);
@@ -14966,6 +16972,7 @@ void QCPGraph::removeData(double fromKey, double toKey)
 */
 void QCPGraph::removeData(double key)
 {
+  ++mDataVersion;
   mData->remove(key);
 }
 
@@ -14975,6 +16982,7 @@ void QCPGraph::removeData(double key)
 */
 void QCPGraph::clearData()
 {
+  ++mDataVersion;
   mData->clear();
 }
 
@@ -15080,6 +17088,7 @@ void QCPGraph::rescaleValueAxis(bool onlyEnlarge, bool includeErrorBars) const
 /* inherits documentation from base class */
 void QCPGraph::draw(QCPPainter *painter)
 {
+  mHitTestIndex.clear(); // replaced by the geometry drawn below
   if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
   if (mKeyAxis.data()->range().size() <= 0 || mData->isEmpty()) return;
   if (mLineStyle == lsNone && mScatterStyle.isNone()) return;
@@ -15087,7 +17096,8 @@ void QCPGraph::draw(QCPPainter *painter)
   // allocate line and (if necessary) point vectors:
   QVector<QPointF> *lineData = new QVector<QPointF>;
   QVector<QCPData> *scatterData = 0;
-  if (!mScatterStyle.isNone())
+  bool previewSkipsScatters = mParentPlot->previewSimplified(QCP::psNoScatters) && (mErrorType == etNone || mParentPlot->previewSimplified(QCP::psNoErrorBars));
+  if (!mScatterStyle.isNone() && !previewSkipsScatters)
     scatterData = new QVector<QCPData>;
   
   // fill vectors with data appropriate to plot style:
@@ -15118,6 +17128,10 @@ void QCPGraph::draw(QCPPainter *painter)
   if (scatterData)
     drawScatterPlot(painter, scatterData);
   
+  // keep the drawn pixel geometry for hit tests, see pointDistance (scatter-only graphs are kept by drawScatterPlot):
+  if (mLineStyle != lsNone)
+    mHitTestIndex.setPoints(*lineData, mLineStyle == lsImpulse ? QCPSegmentIndexPrivate::gLinePairs : QCPSegmentIndexPrivate::gPolyline, hitTestStamp());
+  
   // free allocated line and point vectors:
   delete lineData;
   if (scatterData)
@@ -15479,6 +17493,9 @@ void QCPGraph::getImpulsePlotData(QVector<QPointF> *linePixelData, QVector<QCPDa
   If the fill is a channel fill between this QCPGraph and another QCPGraph (mChannelFillGraph), the
   more complex polygon is calculated with the \ref getChannelFillPolygon function.
   
+  If the fill is drawn non-antialiased with a solid brush on a rasterized output, no polygon is
+  constructed at all and the fill is drawn column by column with \ref drawSpanFill instead.
+  
   \see drawLinePlot
 */
 void QCPGraph::drawFill(QCPPainter *painter, QVector<QPointF> *lineData) const
@@ -15487,6 +17504,11 @@ void QCPGraph::drawFill(QCPPainter *painter, QVector<QPointF> *lineData) const
   if (mainBrush().style() == Qt::NoBrush || mainBrush().color().alpha() == 0) return;
   
   applyFillAntialiasingHint(painter);
+  if (canSpanFill(painter))
+  {
+    drawSpanFill(painter, lineData);
+    return;
+  }
   if (!mChannelFillGraph)
   {
     // draw base fill under graph, fill goes all the way to the zero-value-line:
@@ -15520,7 +17542,7 @@ void QCPGraph::drawScatterPlot(QCPPainter *painter, QVector<QCPData> *scatterDat
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
   
   // draw error bars:
-  if (mErrorType != etNone)
+  if (mErrorType != etNone && !mParentPlot->previewSimplified(QCP::psNoErrorBars))
   {
     applyErrorBarsAntialiasingHint(painter);
     painter->setPen(mErrorPen);
@@ -15536,19 +17558,26 @@ void QCPGraph::drawScatterPlot(QCPPainter *painter, QVector<QCPData> *scatterDat
   }
   
   // draw scatter point symbols:
+  if (mParentPlot->previewSimplified(QCP::psNoScatters))
+    return;
   applyScattersAntialiasingHint(painter);
   mScatterStyle.applyTo(painter, mPen);
+  QVector<QPointF> scatterPixels;
+  scatterPixels.reserve(scatterData->size());
   if (keyAxis->orientation() == Qt::Vertical)
   {
     for (int i=0; i<scatterData->size(); ++i)
       if (!qIsNaN(scatterData->at(i).value))
-        mScatterStyle.drawShape(painter, valueAxis->coordToPixel(scatterData->at(i).value), keyAxis->coordToPixel(scatterData->at(i).key));
+        scatterPixels.append(QPointF(valueAxis->coordToPixel(scatterData->at(i).value), keyAxis->coordToPixel(scatterData->at(i).key)));
   } else
   {
     for (int i=0; i<scatterData->size(); ++i)
       if (!qIsNaN(scatterData->at(i).value))
-        mScatterStyle.drawShape(painter, keyAxis->coordToPixel(scatterData->at(i).key), valueAxis->coordToPixel(scatterData->at(i).value));
+        scatterPixels.append(QPointF(keyAxis->coordToPixel(scatterData->at(i).key), valueAxis->coordToPixel(scatterData->at(i).value)));
   }
+  mScatterStyle.drawShapes(painter, scatterPixels, mParentPlot->plottingHints().testFlag(QCP::phCacheScatters));
+  if (mLineStyle == lsNone) // scatters are the only representation, keep them for hit tests
+    mHitTestIndex.setPoints(scatterPixels, QCPSegmentIndexPrivate::gPoints, hitTestStamp());
 }
 
 /*!  \internal
@@ -15569,6 +17598,13 @@ void QCPGraph::drawLinePlot(QCPPainter *painter, QVector<QPointF> *lineData) con
     painter->setPen(mainPen());
     painter->setBrush(Qt::NoBrush);
     
+    // if enabled and the pen allows it, bypass line stroking with the dedicated rasterizer:
+    if (mFastLineRendering && canRasterizeLinePlot(painter))
+    {
+      rasterizeLinePlot(painter, lineData);
+      return;
+    }
+    
     /* Draws polyline in batches, currently not used:
     int p = 0;
     while (p < lineData->size())
@@ -15674,9 +17710,10 @@ void QCPGraph::getPreparedData(QVector<QCPData> *lineData, QVector<QCPData> *sca
   
   // count points in visible range, taking into account that we only need to count to the limit maxCount if using adaptive sampling:
   int maxCount = std::numeric_limits<int>::max();
+  double samplingPixels = mParentPlot->previewSimplified(QCP::psCoarseSampling) ? 4.0 : 1.0; // width of one sampling interval in pixels
   if (mAdaptiveSampling)
   {
-    int keyPixelSpan = qAbs(keyAxis->coordToPixel(lower.key())-keyAxis->coordToPixel(upper.key()));
+    int keyPixelSpan = qAbs(keyAxis->coordToPixel(lower.key())-keyAxis->coordToPixel(upper.key()))/samplingPixels;
     maxCount = 2*keyPixelSpan+2;
   }
   int dataCount = countDataInBounds(lower, upper, maxCount);
@@ -15694,7 +17731,7 @@ void QCPGraph::getPreparedData(QVector<QCPData> *lineData, QVector<QCPData> *sca
       int reversedRound = keyAxis->rangeReversed() != (keyAxis->orientation()==Qt::Vertical) ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
       double currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(lower.key())+reversedRound));
       double lastIntervalEndKey = currentIntervalStartKey;
-      double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
+      double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+samplingPixels*reversedFactor)); // interval of one sampling interval (usually one pixel) on screen when mapped to plot key coordinates
       bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
       int intervalDataCount = 1;
       ++it; // advance iterator to second data point because adaptive sampling works in 1 point retrospect
@@ -15725,7 +17762,7 @@ void QCPGraph::getPreparedData(QVector<QCPData> *lineData, QVector<QCPData> *sca
           currentIntervalFirstPoint = it;
           currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(it.key())+reversedRound));
           if (keyEpsilonVariable)
-            keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
+            keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+samplingPixels*reversedFactor));
           intervalDataCount = 1;
         }
         ++it;
@@ -15755,7 +17792,7 @@ void QCPGraph::getPreparedData(QVector<QCPData> *lineData, QVector<QCPData> *sca
       int reversedFactor = keyAxis->rangeReversed() ? -1 : 1; // is used to calculate keyEpsilon pixel into the correct direction
       int reversedRound = keyAxis->rangeReversed() ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
       double currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(lower.key())+reversedRound));
-      double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
+      double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+samplingPixels*reversedFactor)); // interval of one sampling interval (usually one pixel) on screen when mapped to plot key coordinates
       bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
       int intervalDataCount = 1;
       ++it; // advance iterator to second data point because adaptive sampling works in 1 point retrospect
@@ -15796,7 +17833,7 @@ void QCPGraph::getPreparedData(QVector<QCPData> *lineData, QVector<QCPData> *sca
           currentIntervalStart = it;
           currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(it.key())+reversedRound));
           if (keyEpsilonVariable)
-            keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
+            keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+samplingPixels*reversedFactor));
           intervalDataCount = 1;
         }
         ++it;
@@ -16394,6 +18431,11 @@ int QCPGraph::findIndexAboveY(const QVector<QPointF> *data, double y) const
   
   If either the graph has no data or if the line style is \ref lsNone and the scatter style's shape
   is \ref QCPScatterStyle::ssNone (i.e. there is no visual representation of the graph), returns -1.0.
+  
+  The line segments (or scatter points) are kept in a spatial index between calls, so repeated hit
+  tests, e.g. for hover effects, only look at the segments near \a pixelPoint. The index is filled
+  with the pixel geometry of the last replot, so as long as the axes and data haven't changed since
+  (see \ref hitTestStamp), the plot data isn't prepared again.
 */
 double QCPGraph::pointDistance(const QPointF &pixelPoint) const
 {
@@ -16402,58 +18444,71 @@ double QCPGraph::pointDistance(const QPointF &pixelPoint) const
   if (mLineStyle == lsNone && mScatterStyle.isNone())
     return -1.0;
   
-  // calculate minimum distances to graph representation:
-  if (mLineStyle == lsNone)
+  // (re)build the hit test index if the pixel representation changed since it was last built:
+  QCPSegmentIndexPrivate::Stamp stamp = hitTestStamp();
+  if (!mHitTestIndex.isValid(stamp))
   {
-    // no line displayed, only calculate distance to scatter points:
-    QVector<QCPData> scatterData;
-    getScatterPlotData(&scatterData);
-    if (scatterData.size() > 0)
+    QVector<QPointF> pixels;
+    if (mLineStyle == lsNone)
     {
-      double minDistSqr = std::numeric_limits<double>::max();
+      // no line displayed, only calculate distance to scatter points:
+      QVector<QCPData> scatterData;
+      getScatterPlotData(&scatterData);
+      pixels.reserve(scatterData.size());
       for (int i=0; i<scatterData.size(); ++i)
-      {
-        double currentDistSqr = QVector2D(coordsToPixels(scatterData.at(i).key, scatterData.at(i).value)-pixelPoint).lengthSquared();
-        if (currentDistSqr < minDistSqr)
-          minDistSqr = currentDistSqr;
-      }
-      return qSqrt(minDistSqr);
-    } else // no data available in view to calculate distance to
-      return -1.0;
-  } else
-  {
-    // line displayed, calculate distance to line segments:
-    QVector<QPointF> lineData;
-    getPlotData(&lineData, 0); // unlike with getScatterPlotData we get pixel coordinates here
-    if (lineData.size() > 1) // at least one line segment, compare distance to line segments
-    {
-      double minDistSqr = std::numeric_limits<double>::max();
-      if (mLineStyle == lsImpulse)
-      {
-        // impulse plot differs from other line styles in that the lineData points are only pairwise connected:
-        for (int i=0; i<lineData.size()-1; i+=2) // iterate pairs
-        {
-          double currentDistSqr = distSqrToLine(lineData.at(i), lineData.at(i+1), pixelPoint);
-          if (currentDistSqr < minDistSqr)
-            minDistSqr = currentDistSqr;
-        }
-      } else
-      {
-        // all other line plots (line and step) connect points directly:
-        for (int i=0; i<lineData.size()-1; ++i)
-        {
-          double currentDistSqr = distSqrToLine(lineData.at(i), lineData.at(i+1), pixelPoint);
-          if (currentDistSqr < minDistSqr)
-            minDistSqr = currentDistSqr;
-        }
-      }
-      return qSqrt(minDistSqr);
-    } else if (lineData.size() > 0) // only single data point, calculate distance to that point
+        pixels.append(coordsToPixels(scatterData.at(i).key, scatterData.at(i).value));
+      mHitTestIndex.setPoints(pixels, QCPSegmentIndexPrivate::gPoints, stamp);
+    } else
     {
-      return QVector2D(lineData.at(0)-pixelPoint).length();
-    } else // no data available in view to calculate distance to
-      return -1.0;
+      // line displayed, calculate distance to line segments. Impulse plot differs from other line styles in that the lineData points are only pairwise connected:
+      getPlotData(&pixels, 0); // unlike with getScatterPlotData we get pixel coordinates here
+      mHitTestIndex.setPoints(pixels, mLineStyle == lsImpulse ? QCPSegmentIndexPrivate::gLinePairs : QCPSegmentIndexPrivate::gPolyline, stamp);
+    }
+  }
+  return mHitTestIndex.distance(pixelPoint); // -1 if no data available in view to calculate distance to
+}
+
+/*! \internal
+  
+  Removes data points from the front of the data map, until the limits set with \ref
+  setMaxDataCount and \ref setMaxKeySpan are satisfied. Called by the methods that add or set
+  data.
+*/
+void QCPGraph::applyRetention()
+{
+  if (mData->isEmpty() || (mMaxDataCount <= 0 && mMaxKeySpan <= 0))
+    return;
+  const int oldSize = mData->size();
+  QCPDataMap::iterator it = mData->begin();
+  if (mMaxDataCount > 0)
+  {
+    while (mData->size() > mMaxDataCount)
+      it = mData->erase(it);
+  }
+  if (mMaxKeySpan > 0)
+  {
+    const double minKey = (mData->constEnd()-1).key()-mMaxKeySpan;
+    while (it != mData->end() && it.key() < minKey)
+      it = mData->erase(it);
   }
+  if (mData->size() != oldSize)
+    ++mDataVersion;
+}
+
+/*! \internal
+  
+  Returns the state of the axes and data that determines the graph's pixel representation. The hit
+  test index used by \ref pointDistance is rebuilt whenever this stamp changes.
+*/
+QCPSegmentIndexPrivate::Stamp QCPGraph::hitTestStamp() const
+{
+  QCPSegmentIndexPrivate::Stamp stamp;
+  stamp.axisRect = mKeyAxis.data()->axisRect()->rect();
+  stamp.keyRange = mKeyAxis.data()->range();
+  stamp.valueRange = mValueAxis.data()->range();
+  stamp.dataCount = mData->size();
+  stamp.dataVersion = mDataVersion;
+  return stamp;
 }
 
 /*! \internal
@@ -16479,6 +18534,295 @@ int QCPGraph::findIndexBelowY(const QVector<QPointF> *data, double y) const
   return -1;
 }
 
+/*! \internal
+  
+  Returns whether the line of the graph can be drawn with \ref rasterizeLinePlot, given the
+  current pen and state of \a painter, without visual difference to drawing it with QPainter.
+  
+  \see setFastLineRendering
+*/
+bool QCPGraph::canRasterizeLinePlot(const QCPPainter *painter) const
+{
+  const QPen pen = painter->pen();
+  return pen.style() == Qt::SolidLine &&
+         pen.brush().style() == Qt::SolidPattern &&
+         pen.widthF() <= 1.0 && // width 0 is a cosmetic one pixel pen
+         !painter->antialiasing() &&
+         !painter->modes().testFlag(QCPPainter::pmVectorized) &&
+         !painter->modes().testFlag(QCPPainter::pmNoCaching) &&
+         painter->transform().type() <= QTransform::TxTranslate;
+}
+
+/*! \internal
+  
+  Draws the line segments connecting the points in \a lineData as one pixel wide, non-antialiased
+  lines in the color of the current pen of \a painter. NaN points create a gap in the line, like in
+  \ref drawLinePlot. Infinite points create a gap, too.
+  
+  Instead of passing each segment to the paint engine, the segments are clipped to the axis rect
+  (see \ref clipLineToRect) and rasterized with an integer Bresenham algorithm, writing the pixels
+  directly into the scanlines of \ref mLineRasterBuffer. The buffer covers the clip rect of the
+  graph and is kept between replots, so it only needs to be cleared before each use. Finally, it is
+  composited onto \a painter with a single image draw call.
+  
+  Must only be called if \ref canRasterizeLinePlot returns true.
+*/
+void QCPGraph::rasterizeLinePlot(QCPPainter *painter, const QVector<QPointF> *lineData) const
+{
+  const QRect bufferRect = clipRect().translated(0, -1); // same as clip rect set by QCustomPlot::draw
+  if (bufferRect.isEmpty() || lineData->size() < 2)
+    return;
+  if (mLineRasterBuffer.size() != bufferRect.size())
+    mLineRasterBuffer = QImage(bufferRect.size(), QImage::Format_ARGB32_Premultiplied);
+  mLineRasterBuffer.fill(0);
+  
+  const QColor color = painter->pen().color();
+  const int alpha = color.alpha();
+  const QRgb pixel = qRgba(color.red()*alpha/255, color.green()*alpha/255, color.blue()*alpha/255, alpha); // premultiplied
+  uchar *bits = mLineRasterBuffer.bits();
+  const int bytesPerLine = mLineRasterBuffer.bytesPerLine();
+  const QRectF bounds(0, 0, bufferRect.width()-1, bufferRect.height()-1);
+  const QPointF offset = bufferRect.topLeft();
+  
+  const int lineDataSize = lineData->size();
+  for (int i=1; i<lineDataSize; ++i)
+  {
+    QPointF start = lineData->at(i-1)-offset;
+    QPointF end = lineData->at(i)-offset;
+    if (!qIsFinite(start.x()) || !qIsFinite(start.y()) || !qIsFinite(end.x()) || !qIsFinite(end.y())) // non-finite points create a gap, clipping infinite coordinates would yield NaN
+      continue;
+    if (!clipLineToRect(start, end, bounds))
+      continue;
+    int x = qRound(start.x());
+    int y = qRound(start.y());
+    const int x1 = qRound(end.x());
+    const int y1 = qRound(end.y());
+    const int dx = qAbs(x1-x);
+    const int dy = -qAbs(y1-y);
+    const int sx = x < x1 ? 1 : -1;
+    const int sy = y < y1 ? 1 : -1;
+    int err = dx+dy;
+    while (true)
+    {
+      reinterpret_cast<QRgb*>(bits+y*bytesPerLine)[x] = pixel;
+      if (x == x1 && y == y1)
+        break;
+      const int err2 = 2*err;
+      if (err2 >= dy)
+      {
+        err += dy;
+        x += sx;
+      }
+      if (err2 <= dx)
+      {
+        err += dx;
+        y += sy;
+      }
+    }
+  }
+  
+  painter->drawImage(bufferRect.topLeft(), mLineRasterBuffer);
+}
+
+/*! \internal
+  
+  Clips the line segment from \a start to \a end to \a rect (Liang-Barsky algorithm), modifying
+  \a start and \a end accordingly. Returns false if the segment lies completely outside of \a rect,
+  in which case \a start and \a end are left unchanged.
+  
+  Used by \ref rasterizeLinePlot, so the rasterizer never iterates over pixels outside its buffer.
+*/
+bool QCPGraph::clipLineToRect(QPointF &start, QPointF &end, const QRectF &rect) const
+{
+  const double dx = end.x()-start.x();
+  const double dy = end.y()-start.y();
+  const double p[4] = {-dx, dx, -dy, dy};
+  const double q[4] = {start.x()-rect.left(), rect.right()-start.x(), start.y()-rect.top(), rect.bottom()-start.y()};
+  double t0 = 0;
+  double t1 = 1;
+  for (int i=0; i<4; ++i)
+  {
+    if (p[i] == 0)
+    {
+      if (q[i] < 0) // parallel to and outside of this boundary
+        return false;
+    } else
+    {
+      const double t = q[i]/p[i];
+      if (p[i] < 0)
+      {
+        if (t > t1)
+          return false;
+        if (t > t0)
+          t0 = t;
+      } else
+      {
+        if (t < t0)
+          return false;
+        if (t < t1)
+          t1 = t;
+      }
+    }
+  }
+  const QPointF origin = start;
+  start = QPointF(origin.x()+t0*dx, origin.y()+t0*dy);
+  end = QPointF(origin.x()+t1*dx, origin.y()+t1*dy);
+  return true;
+}
+
+/*! \internal
+  
+  Returns whether the fill of the graph can be drawn with \ref drawSpanFill, given the current
+  brush and state of \a painter, without visual difference to filling the fill polygon.
+  
+  This is the case for solid brushes that are drawn without antialiasing on rasterized outputs
+  (not vectorized or non-caching, e.g. PDF export), with a painter that doesn't scale or rotate.
+*/
+bool QCPGraph::canSpanFill(const QCPPainter *painter) const
+{
+  return mainBrush().style() == Qt::SolidPattern &&
+         !painter->antialiasing() &&
+         !painter->modes().testFlag(QCPPainter::pmVectorized) &&
+         !painter->modes().testFlag(QCPPainter::pmNoCaching) &&
+         painter->transform().type() <= QTransform::TxTranslate;
+}
+
+/*! \internal
+  
+  Draws the fill of the graph without constructing a fill polygon. Since the keys of a graph are
+  sorted, \a lineData is monotonic in the key pixel coordinate. So for every pixel column (or
+  pixel row, if the key axis is vertical) inside the axis rect, the fill is exactly one span: from
+  the zero-value-line (see \ref lowerFillBasePoint) to the line of the graph or, for a channel fill,
+  from the line of \ref setChannelFillGraph "mChannelFillGraph" to the line of this graph.
+  
+  The line values at the column centers are found with \ref sampleFillColumns. Neighbouring
+  columns with identical spans are merged, and all spans are filled in device pixels with a single
+  call to QPainter::drawRects. Like with the fill polygon, a pixel is filled if its center lies
+  inside the filled area.
+*/
+void QCPGraph::drawSpanFill(QCPPainter *painter, const QVector<QPointF> *lineData) const
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  if (lineData->size() < 2)
+    return;
+  
+  // work in device pixels, so spans align with the pixel grid:
+  const bool keyIsX = keyAxis->orientation() == Qt::Horizontal;
+  const QPointF shift(painter->transform().dx(), painter->transform().dy());
+  const QRect deviceClip = clipRect().translated(qRound(shift.x()), qRound(shift.y())-1); // same clip as set by QCustomPlot::draw
+  const int firstColumn = keyIsX ? deviceClip.left() : deviceClip.top();
+  const int columnCount = keyIsX ? deviceClip.width() : deviceClip.height();
+  const int valueMin = keyIsX ? deviceClip.top() : deviceClip.left();
+  const int valueMax = keyIsX ? deviceClip.bottom()+1 : deviceClip.right()+1; // exclusive
+  if (columnCount <= 0)
+    return;
+  
+  const QVector<double> lineValues = sampleFillColumns(lineData, firstColumn, columnCount, keyIsX, shift);
+  QVector<double> baseValues;
+  if (!mChannelFillGraph)
+  {
+    const QPointF basePoint = lowerFillBasePoint(0)+shift;
+    baseValues = QVector<double>(columnCount, keyIsX ? basePoint.y() : basePoint.x());
+  } else
+  {
+    if (!mChannelFillGraph.data()->mKeyAxis) { qDebug() << Q_FUNC_INFO << "channel fill target key axis invalid"; return; }
+    if (mChannelFillGraph.data()->mKeyAxis.data()->orientation() != keyAxis->orientation())
+      return; // don't have same axis orientation, can't fill that
+    QVector<QPointF> otherData;
+    mChannelFillGraph.data()->getPlotData(&otherData, 0);
+    baseValues = sampleFillColumns(&otherData, firstColumn, columnCount, keyIsX, shift);
+  }
+  
+  QVector<QRect> spans;
+  spans.reserve(columnCount);
+  int lastStart = 0, lastEnd = 0, lastColumn = -2;
+  for (int i=0; i<columnCount; ++i)
+  {
+    const double lineValue = lineValues.at(i);
+    const double baseValue = baseValues.at(i);
+    if (qIsNaN(lineValue) || qIsNaN(baseValue))
+      continue;
+    const double lower = qBound(double(valueMin-1), qMin(lineValue, baseValue), double(valueMax+1));
+    const double upper = qBound(double(valueMin-1), qMax(lineValue, baseValue), double(valueMax+1));
+    const int start = qMax(valueMin, qCeil(lower-0.5));
+    const int end = qMin(valueMax, qCeil(upper-0.5));
+    if (end <= start)
+      continue;
+    if (lastColumn == i-1 && start == lastStart && end == lastEnd) // same span as previous column, widen previous rect
+    {
+      if (keyIsX)
+        spans.last().setRight(spans.last().right()+1);
+      else
+        spans.last().setBottom(spans.last().bottom()+1);
+    } else
+    {
+      const int column = firstColumn+i;
+      spans.append(keyIsX ? QRect(column, start, 1, end-start) : QRect(start, column, end-start, 1));
+    }
+    lastStart = start;
+    lastEnd = end;
+    lastColumn = i;
+  }
+  if (spans.isEmpty())
+    return;
+  
+  painter->setPen(Qt::NoPen);
+  painter->setBrush(mainBrush());
+  const QTransform oldTransform = painter->transform();
+  painter->setTransform(QTransform());
+  painter->drawRects(spans);
+  painter->setTransform(oldTransform);
+}
+
+/*! \internal
+  
+  Returns the value pixel coordinate of the polyline \a lineData at the centers of the
+  \a columnCount pixel columns starting at \a firstColumn, linearly interpolated between the
+  points. If \a keyIsX is true, columns are along the x axis and values are y coordinates,
+  otherwise the other way around. \a shift is added to all points of \a lineData before sampling.
+  
+  Columns not covered by \a lineData, or only by segments adjacent to NaN points, are NaN in the
+  returned vector. Vertical segments (e.g. of step line styles) don't cover any column centers and
+  are thus skipped.
+  
+  Used by \ref drawSpanFill.
+*/
+QVector<double> QCPGraph::sampleFillColumns(const QVector<QPointF> *lineData, int firstColumn, int columnCount, bool keyIsX, const QPointF &shift) const
+{
+  QVector<double> result(columnCount, std::numeric_limits<double>::quiet_NaN());
+  const double keyShift = keyIsX ? shift.x() : shift.y();
+  const double valueShift = keyIsX ? shift.y() : shift.x();
+  const double lowerBound = firstColumn-1;
+  const double upperBound = firstColumn+columnCount+1;
+  for (int i=1; i<lineData->size(); ++i)
+  {
+    const QPointF &a = lineData->at(i-1);
+    const QPointF &b = lineData->at(i);
+    double keyA = (keyIsX ? a.x() : a.y())+keyShift;
+    double valueA = (keyIsX ? a.y() : a.x())+valueShift;
+    double keyB = (keyIsX ? b.x() : b.y())+keyShift;
+    double valueB = (keyIsX ? b.y() : b.x())+valueShift;
+    if (qIsNaN(keyA) || qIsNaN(valueA) || qIsNaN(keyB) || qIsNaN(valueB))
+      continue;
+    if (keyA == keyB)
+      continue;
+    if (keyA > keyB) // descending keys for reversed key axis
+    {
+      qSwap(keyA, keyB);
+      qSwap(valueA, valueB);
+    }
+    // the segment covers all columns whose center lies in [keyA, keyB):
+    const int first = qMax(0, qCeil(qBound(lowerBound, keyA, upperBound)-0.5)-firstColumn);
+    const int last = qMin(columnCount, qCeil(qBound(lowerBound, keyB, upperBound)-0.5)-firstColumn);
+    const double slope = (valueB-valueA)/(keyB-keyA);
+    for (int c=first; c<last; ++c)
+      result[c] = valueA+(firstColumn+c+0.5-keyA)*slope;
+  }
+  return result;
+}
+
 /* inherits documentation from base class */
 QCPRange QCPGraph::getKeyRange(bool &foundRange, SignDomain inSignDomain) const
 {
@@ -16746,21 +19090,71 @@ QCPRange QCPGraph::getValueRange(bool &foundRange, SignDomain inSignDomain, bool
 /*!
   Constructs a curve data point with t, key and value set to zero.
 */
-QCPCurveData::QCPCurveData() :
-  t(0),
-  key(0),
-  value(0)
+QCPCurveData::QCPCurveData() :
+  t(0),
+  key(0),
+  value(0)
+{
+}
+
+/*!
+  Constructs a curve data point with the specified \a t, \a key and \a value.
+*/
+QCPCurveData::QCPCurveData(double t, double key, double value) :
+  t(t),
+  key(key),
+  value(value)
+{
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPCurveClipJobPrivate
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPCurveClipJobPrivate
+  
+  \internal
+  \brief (Private)
+  
+  This is a private class and not part of the public QCustomPlot interface.
+  
+  When the plotting hint \ref QCP::phParallelCurves is set, \ref QCPCurve::getCurveData splits the
+  curve data into consecutive chunks. All chunks except the first are processed by instances of
+  this class in the global QThreadPool, while the first chunk is processed in the calling thread.
+  Each job generates the pixel points of its chunk into \ref lineData and releases one resource of
+  the passed semaphore when done, which the calling thread waits for before it concatenates the
+  chunks in order.
+  
+  Jobs are not auto deleted, the calling thread owns them.
+*/
+
+/*!
+  Creates a job that generates the pixel points of the points from \a begin up to (excluding) \a
+  end of \a curve, using the clip rect given by \a rectLeft, \a rectTop, \a rectRight and \a
+  rectBottom in plot coordinates. When finished, one resource of \a finished is released.
+*/
+QCPCurveClipJobPrivate::QCPCurveClipJobPrivate(const QCPCurve *curve, QCPCurveDataMap::const_iterator begin, QCPCurveDataMap::const_iterator end, double rectLeft, double rectTop, double rectRight, double rectBottom, QSemaphore *finished) :
+  mCurve(curve),
+  mBegin(begin),
+  mEnd(end),
+  mRectLeft(rectLeft),
+  mRectTop(rectTop),
+  mRectRight(rectRight),
+  mRectBottom(rectBottom),
+  mFinished(finished)
 {
+  setAutoDelete(false);
 }
 
 /*!
-  Constructs a curve data point with the specified \a t, \a key and \a value.
+  Generates the pixel points of the chunk, see \ref QCPCurve::getCurveSegmentData.
 */
-QCPCurveData::QCPCurveData(double t, double key, double value) :
-  t(t),
-  key(key),
-  value(value)
+void QCPCurveClipJobPrivate::run()
 {
+  QVector<QPointF> trailingPoints; // stays empty, since only the first chunk contains the first curve point
+  mCurve->getCurveSegmentData(mBegin, mEnd, mRectLeft, mRectTop, mRectRight, mRectBottom, &lineData, &trailingPoints);
+  mFinished->release();
 }
 
 
@@ -16787,6 +19181,13 @@ QCPCurveData::QCPCurveData(double t, double key, double value) :
   \section appearance Changing the appearance
   
   The appearance of the curve is determined by the pen and the brush (\ref setPen, \ref setBrush).
+  
+  \section performance Performance with many points
+  
+  For curves with many points, keep adaptive sampling enabled (\ref setAdaptiveSampling). If the
+  plotting hint \ref QCP::phParallelCurves is set (\ref QCustomPlot::setPlottingHint), curves with
+  more than 100,000 points are clipped to the visible axis rect in several threads.
+  
   \section usage Usage
   
   Like all data representing objects in QCustomPlot, the QCPCurve is a plottable (QCPAbstractPlottable). So
@@ -16808,7 +19209,8 @@ QCPCurveData::QCPCurveData(double t, double key, double value) :
   then takes ownership of the graph.
 */
 QCPCurve::QCPCurve(QCPAxis *keyAxis, QCPAxis *valueAxis) :
-  QCPAbstractPlottable(keyAxis, valueAxis)
+  QCPAbstractPlottable(keyAxis, valueAxis),
+  mAdaptiveSampling(true)
 {
   mData = new QCPCurveDataMap;
   mPen.setColor(Qt::blue);
@@ -16838,6 +19240,7 @@ QCPCurve::~QCPCurve()
 */
 void QCPCurve::setData(QCPCurveDataMap *data, bool copy)
 {
+  ++mDataVersion;
   if (mData == data)
   {
     qDebug() << Q_FUNC_INFO << "The data pointer is already in (and owned by) this plottable" << reinterpret_cast<quintptr>(data);
@@ -16861,6 +19264,7 @@ void QCPCurve::setData(QCPCurveDataMap *data, bool copy)
 */
 void QCPCurve::setData(const QVector<double> &t, const QVector<double> &key, const QVector<double> &value)
 {
+  ++mDataVersion;
   mData->clear();
   int n = t.size();
   n = qMin(n, key.size());
@@ -16882,6 +19286,7 @@ void QCPCurve::setData(const QVector<double> &t, const QVector<double> &key, con
 */
 void QCPCurve::setData(const QVector<double> &key, const QVector<double> &value)
 {
+  ++mDataVersion;
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -16917,6 +19322,27 @@ void QCPCurve::setScatterStyle(const QCPScatterStyle &style)
 void QCPCurve::setLineStyle(QCPCurve::LineStyle style)
 {
   mLineStyle = style;
+  mHitTestIndex.clear();
+}
+
+/*!
+  Sets whether adaptive sampling shall be used when plotting this curve. QCPCurve's adaptive
+  sampling technique can drastically improve the replot performance for curves with a large number
+  of points (e.g. above 10,000), without notably changing the appearance of the curve.
+  
+  Since the points of a curve have no order in key direction, the sampling works differently than
+  for QCPGraph (\ref QCPGraph::setAdaptiveSampling): Consecutive points that fall into the same
+  pixel are merged, keeping only the first and last point of each such run. The line path and the
+  fill therefore deviate from the exact path by less than a pixel, while trajectories that dwell
+  in a small area (e.g. noisy sensor positions) are drawn with a small fraction of their points.
+  Scatter symbols are only drawn once per merged run.
+  
+  Adaptive sampling is enabled by default.
+*/
+void QCPCurve::setAdaptiveSampling(bool enabled)
+{
+  mAdaptiveSampling = enabled;
+  mHitTestIndex.clear();
 }
 
 /*!
@@ -16925,6 +19351,7 @@ void QCPCurve::setLineStyle(QCPCurve::LineStyle style)
 */
 void QCPCurve::addData(const QCPCurveDataMap &dataMap)
 {
+  ++mDataVersion;
   mData->unite(dataMap);
 }
 
@@ -16934,6 +19361,7 @@ void QCPCurve::addData(const QCPCurveDataMap &dataMap)
 */
 void QCPCurve::addData(const QCPCurveData &data)
 {
+  ++mDataVersion;
   mData->insertMulti(data.t, data);
 }
 
@@ -16943,6 +19371,7 @@ void QCPCurve::addData(const QCPCurveData &data)
 */
 void QCPCurve::addData(double t, double key, double value)
 {
+  ++mDataVersion;
   QCPCurveData newData;
   newData.t = t;
   newData.key = key;
@@ -16960,6 +19389,7 @@ void QCPCurve::addData(double t, double key, double value)
 */
 void QCPCurve::addData(double key, double value)
 {
+  ++mDataVersion;
   QCPCurveData newData;
   if (!mData->isEmpty())
     newData.t = (mData->constEnd()-1).key()+1;
@@ -16976,6 +19406,7 @@ void QCPCurve::addData(double key, double value)
 */
 void QCPCurve::addData(const QVector<double> &ts, const QVector<double> &keys, const QVector<double> &values)
 {
+  ++mDataVersion;
   int n = ts.size();
   n = qMin(n, keys.size());
   n = qMin(n, values.size());
@@ -16995,6 +19426,7 @@ void QCPCurve::addData(const QVector<double> &ts, const QVector<double> &keys, c
 */
 void QCPCurve::removeDataBefore(double t)
 {
+  ++mDataVersion;
   QCPCurveDataMap::iterator it = mData->begin();
   while (it != mData->end() && it.key() < t)
     it = mData->erase(it);
@@ -17006,6 +19438,7 @@ void QCPCurve::removeDataBefore(double t)
 */
 void QCPCurve::removeDataAfter(double t)
 {
+  ++mDataVersion;
   if (mData->isEmpty()) return;
   QCPCurveDataMap::iterator it = mData->upperBound(t);
   while (it != mData->end())
@@ -17021,6 +19454,7 @@ void QCPCurve::removeDataAfter(double t)
 */
 void QCPCurve::removeData(double fromt, double tot)
 {
+  ++mDataVersion;
   if (fromt >= tot || mData->isEmpty()) return;
   QCPCurveDataMap::iterator it = mData->upperBound(fromt);
   QCPCurveDataMap::iterator itEnd = mData->upperBound(tot);
@@ -17039,6 +19473,7 @@ void QCPCurve::removeData(double fromt, double tot)
 */
 void QCPCurve::removeData(double t)
 {
+  ++mDataVersion;
   mData->remove(t);
 }
 
@@ -17048,6 +19483,7 @@ void QCPCurve::removeData(double t)
 */
 void QCPCurve::clearData()
 {
+  ++mDataVersion;
   mData->clear();
 }
 
@@ -17068,6 +19504,7 @@ double QCPCurve::selectTest(const QPointF &pos, bool onlySelectable, QVariant *d
 /* inherits documentation from base class */
 void QCPCurve::draw(QCPPainter *painter)
 {
+  mHitTestIndex.clear(); // replaced by the geometry drawn below
   if (mData->isEmpty()) return;
   
   // allocate line vector:
@@ -17146,9 +19583,13 @@ void QCPCurve::draw(QCPPainter *painter)
   }
   
   // draw scatters:
-  if (!mScatterStyle.isNone())
+  if (!mScatterStyle.isNone() && !mParentPlot->previewSimplified(QCP::psNoScatters))
     drawScatterPlot(painter, lineData);
   
+  // keep the drawn pixel geometry for hit tests, see pointDistance:
+  if (mKeyAxis && mValueAxis)
+    mHitTestIndex.setPoints(*lineData, QCPSegmentIndexPrivate::gPolyline, hitTestStamp());
+  
   // free allocated line data:
   delete lineData;
 }
@@ -17198,9 +19639,7 @@ void QCPCurve::drawScatterPlot(QCPPainter *painter, const QVector<QPointF> *poin
   // draw scatter point symbols:
   applyScattersAntialiasingHint(painter);
   mScatterStyle.applyTo(painter, mPen);
-  for (int i=0; i<pointData->size(); ++i)
-    if (!qIsNaN(pointData->at(i).x()) && !qIsNaN(pointData->at(i).y()))
-      mScatterStyle.drawShape(painter,  pointData->at(i));
+  mScatterStyle.drawShapes(painter, *pointData, mParentPlot->plottingHints().testFlag(QCP::phCacheScatters));
 }
 
 /*! \internal
@@ -17215,6 +19654,12 @@ void QCPCurve::drawScatterPlot(QCPPainter *painter, const QVector<QPointF> *poin
   
   Methods that are also involved in the algorithm are: \ref getRegion, \ref getOptimizedPoint, \ref
   getOptimizedCornerPoints \ref mayTraverse, \ref getTraverse, \ref getTraverseCornerPoints.
+  
+  The points are processed by \ref getCurveSegmentData. If the plotting hint \ref
+  QCP::phParallelCurves is set and the curve is large enough, the data is split into consecutive
+  chunks (at least 50,000 points each, at most one per thread), which are processed concurrently
+  by \ref QCPCurveClipJobPrivate instances and concatenated in order, so the result is identical to
+  the serial processing.
 */
 void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
 {
@@ -17230,12 +19675,62 @@ void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
   double rectRight = keyAxis->pixelToCoord(keyAxis->coordToPixel(keyAxis->range().upper)+strokeMargin*((keyAxis->orientation()==Qt::Vertical)!=keyAxis->rangeReversed()?-1:1));
   double rectBottom = valueAxis->pixelToCoord(valueAxis->coordToPixel(valueAxis->range().lower)+strokeMargin*((valueAxis->orientation()==Qt::Horizontal)!=valueAxis->rangeReversed()?-1:1));
   double rectTop = valueAxis->pixelToCoord(valueAxis->coordToPixel(valueAxis->range().upper)-strokeMargin*((valueAxis->orientation()==Qt::Horizontal)!=valueAxis->rangeReversed()?-1:1));
+  QVector<QPointF> trailingPoints; // points that must be applied after all other points (are generated only when handling first point to get virtual segment between last and first point right)
+  const int dataCount = mData->size();
+  const int chunkCount = mParentPlot->plottingHints().testFlag(QCP::phParallelCurves) ? qBound(1, dataCount/50000, QThread::idealThreadCount()) : 1;
+  if (chunkCount > 1)
+  {
+    // the generated points only depend on consecutive point pairs, so chunks can be processed independently and concatenated in order:
+    QVector<QCPCurveDataMap::const_iterator> chunkBegins;
+    chunkBegins.reserve(chunkCount+1);
+    QCPCurveDataMap::const_iterator it = mData->constBegin();
+    for (int i=0; i<chunkCount; ++i)
+    {
+      chunkBegins.append(it);
+      if (i < chunkCount-1)
+        it += dataCount/chunkCount;
+    }
+    chunkBegins.append(mData->constEnd());
+    QSemaphore finishedJobs;
+    QList<QCPCurveClipJobPrivate*> jobs;
+    for (int i=1; i<chunkCount; ++i)
+    {
+      QCPCurveClipJobPrivate *job = new QCPCurveClipJobPrivate(this, chunkBegins.at(i), chunkBegins.at(i+1), rectLeft, rectTop, rectRight, rectBottom, &finishedJobs);
+      jobs.append(job);
+      QThreadPool::globalInstance()->start(job);
+    }
+    getCurveSegmentData(chunkBegins.at(0), chunkBegins.at(1), rectLeft, rectTop, rectRight, rectBottom, lineData, &trailingPoints); // first chunk is processed in this thread
+    finishedJobs.acquire(jobs.size());
+    for (int i=0; i<jobs.size(); ++i)
+      *lineData << jobs.at(i)->lineData;
+    qDeleteAll(jobs);
+  } else
+    getCurveSegmentData(mData->constBegin(), mData->constEnd(), rectLeft, rectTop, rectRight, rectBottom, lineData, &trailingPoints);
+  *lineData << trailingPoints;
+  
+  if (mAdaptiveSampling)
+    decimateCurveData(lineData);
+}
+
+/*! \internal
+  
+  Called by \ref getCurveData to generate the pixel points of the curve points from \a begin up to
+  (excluding) \a end, and append them to \a lineData. Each point is handled together with its
+  predecessor, which for the first curve point is the last curve point. Points that result from
+  this virtual segment are appended to \a trailingPoints instead.
+  
+  This method only reads the curve data and axes, so it may be called concurrently for different
+  ranges (see \ref QCP::phParallelCurves).
+*/
+void QCPCurve::getCurveSegmentData(QCPCurveDataMap::const_iterator begin, QCPCurveDataMap::const_iterator end, double rectLeft, double rectTop, double rectRight, double rectBottom, QVector<QPointF> *lineData, QVector<QPointF> *trailingPoints) const
+{
+  if (begin == end)
+    return;
   int currentRegion;
-  QCPCurveDataMap::const_iterator it = mData->constBegin();
-  QCPCurveDataMap::const_iterator prevIt = mData->constEnd()-1;
+  QCPCurveDataMap::const_iterator it = begin;
+  QCPCurveDataMap::const_iterator prevIt = begin == mData->constBegin() ? mData->constEnd()-1 : begin-1; // the first point forms a virtual segment with the last point
   int prevRegion = getRegion(prevIt.value().key, prevIt.value().value, rectLeft, rectTop, rectRight, rectBottom);
-  QVector<QPointF> trailingPoints; // points that must be applied after all other points (are generated only when handling first point to get virtual segment between last and first point right)
-  while (it != mData->constEnd())
+  while (it != end)
   {
     currentRegion = getRegion(it.value().key, it.value().value, rectLeft, rectTop, rectRight, rectBottom);
     if (currentRegion != prevRegion) // changed region, possibly need to add some optimized edge points or original points if entering R
@@ -17264,7 +19759,7 @@ void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
           {
             lineData->append(crossB);
             *lineData << afterTraverseCornerPoints;
-            trailingPoints << beforeTraverseCornerPoints << crossA ;
+            *trailingPoints << beforeTraverseCornerPoints << crossA ;
           }
         } else // doesn't cross R, line is just moving around in outside regions, so only need to add optimized point(s) at the boundary corner(s)
         {
@@ -17273,7 +19768,7 @@ void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
       } else // segment does end in R, so we add previous point optimized and this point at original position
       {
         if (it == mData->constBegin()) // it is first point in curve and prevIt is last one. So save optimized point for adding it to the lineData in the end
-          trailingPoints << getOptimizedPoint(prevRegion, prevIt.value().key, prevIt.value().value, it.value().key, it.value().value, rectLeft, rectTop, rectRight, rectBottom);
+          *trailingPoints << getOptimizedPoint(prevRegion, prevIt.value().key, prevIt.value().value, it.value().key, it.value().value, rectLeft, rectTop, rectRight, rectBottom);
         else
           lineData->append(getOptimizedPoint(prevRegion, prevIt.value().key, prevIt.value().value, it.value().key, it.value().value, rectLeft, rectTop, rectRight, rectBottom));
         lineData->append(coordsToPixels(it.value().key, it.value().value));
@@ -17292,7 +19787,48 @@ void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
     prevRegion = currentRegion;
     ++it;
   }
-  *lineData << trailingPoints;
+}
+
+/*! \internal
+  
+  Called by \ref getCurveData when adaptive sampling is enabled (\ref setAdaptiveSampling).
+  Removes points from the pixel coordinates in \a lineData, which are consecutive and lie in the
+  same pixel cell, keeping the first and last point of each such run. NaN points, which cause gaps
+  in the line, are always kept.
+  
+  When a reduced quality preview is drawn with \ref QCP::psCoarseSampling, the cells are four
+  pixels wide.
+  
+  The points are compacted in place, so no additional memory is allocated.
+*/
+void QCPCurve::decimateCurveData(QVector<QPointF> *lineData) const
+{
+  const int dataCount = lineData->size();
+  if (dataCount < 3)
+    return;
+  const double cellSize = mParentPlot->previewSimplified(QCP::psCoarseSampling) ? 4.0 : 1.0;
+  QPointF *points = lineData->data();
+  int keepCount = 0;
+  int i = 0;
+  while (i < dataCount)
+  {
+    if (qIsNaN(points[i].x()) || qIsNaN(points[i].y()))
+    {
+      points[keepCount++] = points[i++];
+      continue;
+    }
+    const int cellX = qFloor(points[i].x()/cellSize);
+    const int cellY = qFloor(points[i].y()/cellSize);
+    int runEnd = i+1;
+    while (runEnd < dataCount && !qIsNaN(points[runEnd].x()) && !qIsNaN(points[runEnd].y()) &&
+           qFloor(points[runEnd].x()/cellSize) == cellX && qFloor(points[runEnd].y()/cellSize) == cellY)
+      ++runEnd;
+    points[keepCount++] = points[i];
+    if (runEnd-i > 1)
+      points[keepCount++] = points[runEnd-1];
+    i = runEnd;
+  }
+  lineData->resize(keepCount);
 }
 
 /*! \internal
@@ -17909,6 +20445,9 @@ void QCPCurve::getTraverseCornerPoints(int prevRegion, int currentRegion, double
   Calculates the (minimum) distance (in pixels) the curve's representation has from the given \a
   pixelPoint in pixels. This is used to determine whether the curve was clicked or not, e.g. in
   \ref selectTest.
+  
+  Reuses the curve points of the last replot if the axes and data haven't changed since, see \ref
+  hitTestStamp.
 */
 double QCPCurve::pointDistance(const QPointF &pixelPoint) const
 {
@@ -17923,18 +20462,32 @@ double QCPCurve::pointDistance(const QPointF &pixelPoint) const
     return QVector2D(dataPoint-pixelPoint).length();
   }
   
-  // calculate minimum distance to line segments:
-  QVector<QPointF> *lineData = new QVector<QPointF>;
-  getCurveData(lineData);
-  double minDistSqr = std::numeric_limits<double>::max();
-  for (int i=0; i<lineData->size()-1; ++i)
+  // calculate minimum distance to line segments, (re)building the hit test index if the curve's pixel representation changed:
+  QCPSegmentIndexPrivate::Stamp stamp = hitTestStamp();
+  if (!mHitTestIndex.isValid(stamp))
   {
-    double currentDistSqr = distSqrToLine(lineData->at(i), lineData->at(i+1), pixelPoint);
-    if (currentDistSqr < minDistSqr)
-      minDistSqr = currentDistSqr;
+    QVector<QPointF> lineData;
+    getCurveData(&lineData);
+    mHitTestIndex.setPoints(lineData, QCPSegmentIndexPrivate::gPolyline, stamp);
   }
-  delete lineData;
-  return qSqrt(minDistSqr);
+  double distance = mHitTestIndex.distance(pixelPoint);
+  return distance < 0 ? qSqrt(std::numeric_limits<double>::max()) : distance;
+}
+
+/*! \internal
+  
+  Returns the state of the axes and data that determines the curve's pixel representation. The hit
+  test index used by \ref pointDistance is rebuilt whenever this stamp changes.
+*/
+QCPSegmentIndexPrivate::Stamp QCPCurve::hitTestStamp() const
+{
+  QCPSegmentIndexPrivate::Stamp stamp;
+  stamp.axisRect = mKeyAxis.data()->axisRect()->rect();
+  stamp.keyRange = mKeyAxis.data()->range();
+  stamp.valueRange = mValueAxis.data()->range();
+  stamp.dataCount = mData->size();
+  stamp.dataVersion = mDataVersion;
+  return stamp;
 }
 
 /* inherits documentation from base class */
@@ -18782,30 +21335,51 @@ void QCPBars::draw(QCPPainter *painter)
   
   QCPBarDataMap::const_iterator it, lower, upperEnd;
   getVisibleDataBounds(lower, upperEnd);
+  
+  // determine stacked base values of all visible bars in one pass per bars plottable of the stack:
+  QVector<double> keys;
   for (it = lower; it != upperEnd; ++it)
+    keys.append(it.key());
+  if (keys.isEmpty()) return;
+  QVector<double> positiveBases, negativeBases;
+  getStackedBaseValues(keys, positiveBases, negativeBases);
+  
+  // collect bar geometry, so all fills and all outlines are drawn with one call each:
+  const bool drawFill = mainBrush().style() != Qt::NoBrush && mainBrush().color().alpha() != 0;
+  const bool drawOutline = mainPen().style() != Qt::NoPen && mainPen().color().alpha() != 0;
+  QVector<QRectF> barRects;
+  QPainterPath barOutlines;
+  if (drawFill)
+    barRects.reserve(keys.size());
+  int i = 0;
+  for (it = lower; it != upperEnd; ++it, ++i)
   {
     // check data validity if flag set:
 #ifdef QCUSTOMPLOT_CHECK_DATA
     if (QCP::isInvalidData(it.value().key, it.value().value))
       qDebug() << Q_FUNC_INFO << "Data point at" << it.key() << "of drawn range invalid." << "Plottable name:" << name();
 #endif
-    QPolygonF barPolygon = getBarPolygon(it.key(), it.value().value);
-    // draw bar fill:
-    if (mainBrush().style() != Qt::NoBrush && mainBrush().color().alpha() != 0)
-    {
-      applyFillAntialiasingHint(painter);
-      painter->setPen(Qt::NoPen);
-      painter->setBrush(mainBrush());
-      painter->drawPolygon(barPolygon);
-    }
-    // draw bar line:
-    if (mainPen().style() != Qt::NoPen && mainPen().color().alpha() != 0)
-    {
-      applyDefaultAntialiasingHint(painter);
-      painter->setPen(mainPen());
-      painter->setBrush(Qt::NoBrush);
-      painter->drawPolyline(barPolygon);
-    }
+    QPolygonF barPolygon = getBarPolygon(it.key(), it.value().value, it.value().value >= 0 ? positiveBases.at(i) : negativeBases.at(i));
+    if (drawFill)
+      barRects.append(QRectF(barPolygon.at(0), barPolygon.at(2)).normalized()); // bars are axis aligned, so the fill is the rect spanned by base and value corners
+    if (drawOutline)
+      barOutlines.addPolygon(barPolygon); // adds an open subpath, so the bar base isn't drawn
+  }
+  // draw bar fills:
+  if (drawFill)
+  {
+    applyFillAntialiasingHint(painter);
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(mainBrush());
+    painter->drawRects(barRects);
+  }
+  // draw bar lines:
+  if (drawOutline)
+  {
+    applyDefaultAntialiasingHint(painter);
+    painter->setPen(mainPen());
+    painter->setBrush(Qt::NoBrush);
+    painter->drawPath(barOutlines);
   }
 }
 
@@ -18890,6 +21464,18 @@ void QCPBars::getVisibleDataBounds(QCPBarDataMap::const_iterator &lower, QCPBarD
   setBaseValue).
 */
 QPolygonF QCPBars::getBarPolygon(double key, double value) const
+{
+  return getBarPolygon(key, value, getStackedBaseValue(key, value >= 0));
+}
+
+/*! \internal
+  
+  \overload
+  
+  Returns the polygon of a single bar with \a key and \a value, which starts at the given \a base
+  value. Used by \ref draw with base values precomputed by \ref getStackedBaseValues.
+*/
+QPolygonF QCPBars::getBarPolygon(double key, double value, double base) const
 {
   QCPAxis *keyAxis = mKeyAxis.data();
   QCPAxis *valueAxis = mValueAxis.data();
@@ -18898,7 +21484,6 @@ QPolygonF QCPBars::getBarPolygon(double key, double value) const
   QPolygonF result;
   double lowerPixelWidth, upperPixelWidth;
   getPixelWidth(key, lowerPixelWidth, upperPixelWidth);
-  double base = getStackedBaseValue(key, value >= 0);
   double basePixel = valueAxis->coordToPixel(base);
   double valuePixel = valueAxis->coordToPixel(base+value);
   double keyPixel = keyAxis->coordToPixel(key);
@@ -19005,6 +21590,58 @@ double QCPBars::getStackedBaseValue(double key, bool positive) const
     return mBaseValue;
 }
 
+/*! \internal
+  
+  Determines the stacked base values (see \ref getStackedBaseValue) for all \a keys at once. \a
+  keys must be sorted ascendingly. The base values for positive bars are returned in \a
+  positiveBases, the ones for negative bars in \a negativeBases, with the same indices as \a keys.
+  
+  Instead of searching the bars below for every key separately and recursing down the stack for
+  each of them, the bars below are traversed once in parallel with \a keys, and the recursion
+  happens only once per bars plottable in the stack.
+*/
+void QCPBars::getStackedBaseValues(const QVector<double> &keys, QVector<double> &positiveBases, QVector<double> &negativeBases) const
+{
+  if (!mBarBelow)
+  {
+    positiveBases.fill(mBaseValue, keys.size());
+    negativeBases.fill(mBaseValue, keys.size());
+    return;
+  }
+  mBarBelow.data()->getStackedBaseValues(keys, positiveBases, negativeBases);
+  const QCPBarDataMap *belowData = mBarBelow.data()->mData;
+  QCPBarDataMap::const_iterator it = belowData->constEnd();
+  double previousLowerKey = 0;
+  for (int i=0; i<keys.size(); ++i)
+  {
+    const double key = keys.at(i);
+    double epsilon = qAbs(key)*1e-6; // same tolerance as in getStackedBaseValue
+    if (key == 0)
+      epsilon = 1e-6;
+    // move to the first bar below that is approximately at key. The search key only decreases for the bar at key 0, then search again:
+    if (i == 0 || key-epsilon < previousLowerKey)
+      it = belowData->lowerBound(key-epsilon);
+    else
+    {
+      while (it != belowData->constEnd() && it.key() < key-epsilon)
+        ++it;
+    }
+    previousLowerKey = key-epsilon;
+    // find largest positive and negative bars below at key:
+    double positiveMax = 0;
+    double negativeMax = 0;
+    for (QCPBarDataMap::const_iterator barIt = it; barIt != belowData->constEnd() && barIt.key() <= key+epsilon; ++barIt)
+    {
+      if (barIt.value().value > positiveMax)
+        positiveMax = barIt.value().value;
+      if (barIt.value().value < negativeMax)
+        negativeMax = barIt.value().value;
+    }
+    positiveBases[i] += positiveMax;
+    negativeBases[i] += negativeMax;
+  }
+}
+
 /*! \internal
 
   Connects \a below and \a above to each other via their mBarAbove/mBarBelow properties. The bar(s)
@@ -19121,9 +21758,321 @@ QCPRange QCPBars::getValueRange(bool &foundRange, SignDomain inSignDomain) const
     }
     ++it;
   }
-  
-  foundRange = true; // return true because bar charts always have the 0-line visible
-  return range;
+  
+  foundRange = true; // return true because bar charts always have the 0-line visible
+  return range;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPHistogram
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPHistogram
+  \brief Incremental histogram of a stream of samples, which feeds its bin counts into a QCPBars
+  
+  QCPHistogram divides the range from \ref lower to \ref upper into \ref binCount bins of equal
+  width, either on a linear or a logarithmic scale (\ref BinScale). Each sample passed to \ref
+  addSample increments the count of its bin in constant time, no matter how many samples were
+  added before. Samples outside the range are counted in \ref underflowCount and \ref
+  overflowCount, NaN samples are ignored.
+  
+  With \ref setCountMode, the counts can be restricted to the most recent samples (\ref
+  cmWindowed), or older samples can be faded out exponentially (\ref cmDecaying). Both modes also
+  take constant time per sample.
+  
+  To display the histogram, pass a QCPBars plottable to \ref setBars and call \ref updateBars before
+  a replot. Only the bins that changed since the last update are written to the bars:
+  \code
+  QCPHistogram *histogram = new QCPHistogram(0, 600, 60);
+  histogram->setBars(new QCPBars(customPlot->xAxis, customPlot->yAxis));
+  // for every new sample:
+  histogram->addSample(distance);
+  // before replotting:
+  histogram->updateBars();
+  customPlot->replot();
+  \endcode
+  
+  The bars are placed at the bin centers. For linear bins, \ref setBars also sets the bar width to
+  the bin width. For logarithmic bins, use a logarithmic key axis and choose a bar width type
+  suitable for it, e.g. \ref QCPBars::wtAxisRectRatio.
+*/
+
+/*!
+  Creates a histogram with \a binCount bins between \a lower and \a upper, divided according to \a
+  scale. The count mode is \ref cmCumulative.
+*/
+QCPHistogram::QCPHistogram(double lower, double upper, int binCount, BinScale scale) :
+  mLower(lower),
+  mUpper(upper),
+  mBinCount(qMax(1, binCount)),
+  mBinScale(scale),
+  mCountMode(cmCumulative),
+  mWindowSize(1000),
+  mDecayFactor(0.999),
+  mBars(0),
+  mSampleWeight(1.0),
+  mWindowPosition(0),
+  mWindowFill(0),
+  mAllBinsChanged(true)
+{
+  if (mBinScale == bsLogarithmic && mLower <= 0)
+  {
+    qDebug() << Q_FUNC_INFO << "logarithmic bins require a positive lower bound:" << mLower;
+    mBinScale = bsLinear;
+  }
+  if (mUpper <= mLower)
+  {
+    qDebug() << Q_FUNC_INFO << "upper bound must be larger than lower bound:" << mLower << mUpper;
+    mUpper = mLower+1;
+  }
+  if (mBinScale == bsLogarithmic)
+  {
+    mScaledLower = qLn(mLower);
+    mBinsPerUnit = mBinCount/(qLn(mUpper)-mScaledLower);
+  } else
+  {
+    mScaledLower = mLower;
+    mBinsPerUnit = mBinCount/(mUpper-mLower);
+  }
+  mCounts.fill(0, mBinCount+2); // slot 0 holds the underflow, slot mBinCount+1 the overflow
+  mBinChanged.fill(false, mBinCount+2);
+}
+
+/*!
+  Sets how long samples contribute to the bin counts. Changing the count mode clears the
+  histogram.
+  
+  \see setWindowSize, setDecayFactor
+*/
+void QCPHistogram::setCountMode(CountMode mode)
+{
+  if (mCountMode != mode)
+  {
+    mCountMode = mode;
+    clear();
+  }
+}
+
+/*!
+  Sets the number of most recent samples that are counted, if the count mode is \ref cmWindowed.
+  Setting the window size clears the histogram.
+*/
+void QCPHistogram::setWindowSize(int sampleCount)
+{
+  mWindowSize = qMax(1, sampleCount);
+  clear();
+}
+
+/*!
+  Sets the factor by which the weight of all previous samples is multiplied for every new sample,
+  if the count mode is \ref cmDecaying. \a factor must be between 0 and 1, e.g. with 0.999 a sample
+  has half its weight after about 700 newer samples. Setting the decay factor clears the
+  histogram.
+*/
+void QCPHistogram::setDecayFactor(double factor)
+{
+  if (factor > 0 && factor <= 1)
+  {
+    mDecayFactor = factor;
+    clear();
+  } else
+    qDebug() << Q_FUNC_INFO << "decay factor must be in the range (0, 1]:" << factor;
+}
+
+/*!
+  Sets the \a bars plottable which displays this histogram. The data of \a bars is replaced with
+  one bar per bin right away, afterwards \ref updateBars only writes changed bins. Pass 0 to detach
+  the histogram from its bars.
+  
+  The histogram doesn't take ownership of \a bars.
+*/
+void QCPHistogram::setBars(QCPBars *bars)
+{
+  mBars = bars;
+  if (!bars)
+    return;
+  if (mBinScale == bsLinear)
+  {
+    bars->setWidthType(QCPBars::wtPlotCoords);
+    bars->setWidth((mUpper-mLower)/mBinCount);
+  }
+  QVector<double> keys(mBinCount), values(mBinCount);
+  for (int i=0; i<mBinCount; ++i)
+  {
+    keys[i] = binCenter(i);
+    values[i] = count(i);
+  }
+  bars->setData(keys, values);
+  for (int i=0; i<mChangedBins.size(); ++i)
+    mBinChanged[mChangedBins.at(i)] = false;
+  mChangedBins.clear();
+  mAllBinsChanged = false;
+}
+
+/*!
+  Adds the sample \a value to the histogram, in constant time.
+*/
+void QCPHistogram::addSample(double value)
+{
+  if (qIsNaN(value))
+    return;
+  const int slot = binIndex(value)+1;
+  switch (mCountMode)
+  {
+    case cmCumulative:
+    {
+      addToSlot(slot, 1.0);
+      break;
+    }
+    case cmWindowed:
+    {
+      if (mWindow.size() != mWindowSize)
+        mWindow.resize(mWindowSize);
+      if (mWindowFill == mWindowSize)
+        addToSlot(mWindow.at(mWindowPosition), -1.0); // oldest sample leaves the window
+      else
+        ++mWindowFill;
+      mWindow[mWindowPosition] = slot;
+      mWindowPosition = (mWindowPosition+1)%mWindowSize;
+      addToSlot(slot, 1.0);
+      break;
+    }
+    case cmDecaying:
+    {
+      // instead of multiplying all counts with the decay factor, new samples get a growing weight, which count() divides by:
+      mSampleWeight /= mDecayFactor;
+      if (mSampleWeight > 1e100)
+      {
+        for (int i=0; i<mCounts.size(); ++i)
+          mCounts[i] /= mSampleWeight;
+        mSampleWeight = 1.0;
+      }
+      addToSlot(slot, mSampleWeight);
+      mAllBinsChanged = true; // the counts of all bins decayed
+      break;
+    }
+  }
+}
+
+/*! \overload
+  
+  Adds \a count samples from the array \a values.
+*/
+void QCPHistogram::addSamples(const double *values, int count)
+{
+  for (int i=0; i<count; ++i)
+    addSample(values[i]);
+}
+
+/*!
+  Removes all samples from the histogram.
+*/
+void QCPHistogram::clear()
+{
+  mCounts.fill(0);
+  mSampleWeight = 1.0;
+  mWindow.clear();
+  mWindowPosition = 0;
+  mWindowFill = 0;
+  mAllBinsChanged = true;
+}
+
+/*!
+  Returns the index of the bin that contains \a value. Values below \ref lower return -1, values
+  above \ref upper return \ref binCount. The upper bound itself belongs to the last bin.
+*/
+int QCPHistogram::binIndex(double value) const
+{
+  if (value < mLower)
+    return -1;
+  if (value > mUpper)
+    return mBinCount;
+  const double scaledValue = mBinScale == bsLogarithmic ? qLn(value) : value;
+  return qMin(int((scaledValue-mScaledLower)*mBinsPerUnit), mBinCount-1);
+}
+
+/*!
+  Returns the lower bound of \a bin.
+*/
+double QCPHistogram::binLower(int bin) const
+{
+  const double scaledBound = mScaledLower+bin/mBinsPerUnit;
+  return mBinScale == bsLogarithmic ? qExp(scaledBound) : scaledBound;
+}
+
+/*!
+  Returns the upper bound of \a bin.
+*/
+double QCPHistogram::binUpper(int bin) const
+{
+  return binLower(bin+1);
+}
+
+/*!
+  Returns the center of \a bin, which is the arithmetic mean of its bounds for linear bins, and the
+  geometric mean for logarithmic bins.
+*/
+double QCPHistogram::binCenter(int bin) const
+{
+  const double scaledCenter = mScaledLower+(bin+0.5)/mBinsPerUnit;
+  return mBinScale == bsLogarithmic ? qExp(scaledCenter) : scaledCenter;
+}
+
+/*!
+  Returns the count of \a bin. For the count mode \ref cmDecaying, this is the sum of the decayed
+  sample weights. Passing -1 or \ref binCount returns the underflow or overflow count.
+*/
+double QCPHistogram::count(int bin) const
+{
+  if (bin < -1 || bin > mBinCount)
+    return 0;
+  return mCounts.at(bin+1)/mSampleWeight;
+}
+
+/*!
+  Writes the counts of all bins that changed since the last update to the bars set with \ref
+  setBars. This takes time proportional to the number of changed bins, not the number of samples.
+  In the count mode \ref cmDecaying, all bins change with every sample, so all bins are written.
+*/
+void QCPHistogram::updateBars()
+{
+  if (!mBars)
+    return;
+  QCPBarDataMap *data = mBars.data()->data();
+  if (mAllBinsChanged || data->size() != mBinCount)
+  {
+    setBars(mBars.data());
+    return;
+  }
+  for (int i=0; i<mChangedBins.size(); ++i)
+  {
+    const int bin = mChangedBins.at(i)-1;
+    mBinChanged[mChangedBins.at(i)] = false;
+    if (bin < 0 || bin >= mBinCount) // underflow and overflow aren't displayed
+      continue;
+    const double key = binCenter(bin);
+    QCPBarDataMap::iterator it = data->find(key);
+    if (it != data->end())
+      it.value().value = count(bin);
+    else
+      data->insert(key, QCPBarData(key, count(bin)));
+  }
+  mChangedBins.clear();
+}
+
+/*! \internal
+  
+  Adds \a weight to the count of \a slot (the bin index plus one) and records the bin as changed.
+*/
+void QCPHistogram::addToSlot(int slot, double weight)
+{
+  mCounts[slot] += weight;
+  if (!mBinChanged.at(slot) && !mAllBinsChanged)
+  {
+    mBinChanged[slot] = true;
+    mChangedBins.append(slot);
+  }
 }
 
 
@@ -19496,6 +22445,8 @@ void QCPStatisticalBox::drawWhiskers(QCPPainter *painter) const
 */
 void QCPStatisticalBox::drawOutliers(QCPPainter *painter) const
 {
+  if (mParentPlot->previewSimplified(QCP::psNoScatters))
+    return;
   applyScattersAntialiasingHint(painter);
   mOutlierStyle.applyTo(painter, mPen);
   for (int i=0; i<mOutliers.size(); ++i)
@@ -19579,6 +22530,263 @@ QCPRange QCPStatisticalBox::getValueRange(bool &foundRange, SignDomain inSignDom
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPQuantileEstimator
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPQuantileEstimator
+  \brief Estimates a quantile of a stream of samples in constant memory
+  
+  QCPQuantileEstimator implements the P² algorithm by Jain and Chlamtac ("The P² algorithm for
+  dynamic calculation of quantiles and histograms without storing observations", 1985). It keeps
+  five markers, the minimum, the maximum, the estimated \ref quantile and two intermediate
+  positions, and adjusts their heights with a piecewise parabolic interpolation for every sample.
+  Each sample takes constant time and the memory doesn't grow with the number of samples.
+  
+  While fewer than five samples were added, the estimate is the exact quantile of the samples. The
+  \ref minimum and \ref maximum are always exact.
+  
+  To estimate the values of a box plot, use \ref QCPBoxStatistics.
+*/
+
+/*!
+  Creates an estimator for the \a quantile, which must be between 0 and 1. For example, 0.5
+  estimates the median.
+*/
+QCPQuantileEstimator::QCPQuantileEstimator(double quantile) :
+  mQuantile(qBound(0.0, quantile, 1.0))
+{
+  mIncrements[0] = 0;
+  mIncrements[1] = mQuantile/2.0;
+  mIncrements[2] = mQuantile;
+  mIncrements[3] = (1.0+mQuantile)/2.0;
+  mIncrements[4] = 1;
+  clear();
+}
+
+/*!
+  Adds the sample \a value to the estimation. NaN values are ignored.
+*/
+void QCPQuantileEstimator::addSample(double value)
+{
+  if (qIsNaN(value))
+    return;
+  if (mCount < 5) // collect the first five samples, sorted, as initial marker heights
+  {
+    int i = int(mCount);
+    while (i > 0 && mHeights[i-1] > value)
+    {
+      mHeights[i] = mHeights[i-1];
+      --i;
+    }
+    mHeights[i] = value;
+    ++mCount;
+    return;
+  }
+  ++mCount;
+  
+  // find the cell k of the sample between the marker heights, extending the extreme markers if necessary:
+  int k;
+  if (value < mHeights[0])
+  {
+    mHeights[0] = value;
+    k = 0;
+  } else if (value >= mHeights[4])
+  {
+    mHeights[4] = value;
+    k = 3;
+  } else
+  {
+    k = 0;
+    while (k < 3 && value >= mHeights[k+1])
+      ++k;
+  }
+  
+  // shift positions of the markers above the sample and advance the desired positions:
+  for (int i=k+1; i<5; ++i)
+    mPositions[i] += 1;
+  for (int i=0; i<5; ++i)
+    mDesiredPositions[i] += mIncrements[i];
+  
+  // adjust the heights of the three middle markers if they are off their desired positions:
+  for (int i=1; i<4; ++i)
+  {
+    const double offset = mDesiredPositions[i]-mPositions[i];
+    if ((offset >= 1 && mPositions[i+1]-mPositions[i] > 1) ||
+        (offset <= -1 && mPositions[i-1]-mPositions[i] < -1))
+    {
+      const int d = offset > 0 ? 1 : -1;
+      const double height = parabolicHeight(i, d);
+      if (mHeights[i-1] < height && height < mHeights[i+1])
+        mHeights[i] = height;
+      else
+        mHeights[i] = linearHeight(i, d);
+      mPositions[i] += d;
+    }
+  }
+}
+
+/*!
+  Removes all samples from the estimation.
+*/
+void QCPQuantileEstimator::clear()
+{
+  mCount = 0;
+  for (int i=0; i<5; ++i)
+  {
+    mHeights[i] = 0;
+    mPositions[i] = i+1;
+  }
+  mDesiredPositions[0] = 1;
+  mDesiredPositions[1] = 1+2*mQuantile;
+  mDesiredPositions[2] = 1+4*mQuantile;
+  mDesiredPositions[3] = 3+2*mQuantile;
+  mDesiredPositions[4] = 5;
+}
+
+/*!
+  Returns the current estimate of the \ref quantile, or NaN if no samples were added.
+*/
+double QCPQuantileEstimator::estimate() const
+{
+  if (mCount == 0)
+    return std::numeric_limits<double>::quiet_NaN();
+  if (mCount < 5) // exact quantile of the sorted initial samples
+    return mHeights[qRound(mQuantile*(mCount-1))];
+  return mHeights[2];
+}
+
+/*!
+  Returns the smallest sample added, or NaN if no samples were added.
+*/
+double QCPQuantileEstimator::minimum() const
+{
+  return mCount > 0 ? mHeights[0] : std::numeric_limits<double>::quiet_NaN();
+}
+
+/*!
+  Returns the largest sample added, or NaN if no samples were added.
+*/
+double QCPQuantileEstimator::maximum() const
+{
+  if (mCount == 0)
+    return std::numeric_limits<double>::quiet_NaN();
+  return mCount < 5 ? mHeights[mCount-1] : mHeights[4];
+}
+
+/*! \internal
+  
+  Returns the height of marker \a i when moved by \a d positions, using the piecewise parabolic
+  (P²) prediction formula.
+*/
+double QCPQuantileEstimator::parabolicHeight(int i, double d) const
+{
+  return mHeights[i] + d/(mPositions[i+1]-mPositions[i-1])*(
+        (mPositions[i]-mPositions[i-1]+d)*(mHeights[i+1]-mHeights[i])/(mPositions[i+1]-mPositions[i]) +
+        (mPositions[i+1]-mPositions[i]-d)*(mHeights[i]-mHeights[i-1])/(mPositions[i]-mPositions[i-1]));
+}
+
+/*! \internal
+  
+  Returns the height of marker \a i when moved by \a d positions, using linear interpolation
+  towards the neighbouring marker. Used when the parabolic prediction would violate the marker
+  order.
+*/
+double QCPQuantileEstimator::linearHeight(int i, int d) const
+{
+  return mHeights[i] + d*(mHeights[i+d]-mHeights[i])/(mPositions[i+d]-mPositions[i]);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPBoxStatistics
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPBoxStatistics
+  \brief Streaming estimation of the values of a box plot, which can be applied to a QCPStatisticalBox
+  
+  QCPBoxStatistics estimates the quartiles and the median of a stream of samples with three \ref
+  QCPQuantileEstimator instances, and tracks the exact minimum and maximum. It uses constant memory
+  and constant time per sample, so the raw samples don't need to be stored.
+  
+  \ref applyTo passes the current values to a QCPStatisticalBox, with the minimum and maximum as
+  whisker ends. Outliers can't be determined without the raw samples, so the outliers of the box
+  are left unchanged.
+  
+  For rolling box plots, e.g. one box per minute, use one QCPBoxStatistics per window and start a new
+  box when a window is complete:
+  \code
+  // for every new sample:
+  if (time >= windowEnd)
+  {
+    currentBox = new QCPStatisticalBox(customPlot->xAxis, customPlot->yAxis);
+    customPlot->addPlottable(currentBox);
+    currentBox->setKey(windowEnd+30); // center of the new minute
+    statistics.clear();
+    windowEnd += 60;
+  }
+  statistics.addSample(value);
+  statistics.applyTo(currentBox);
+  \endcode
+*/
+
+/*!
+  Creates an empty box statistics instance.
+*/
+QCPBoxStatistics::QCPBoxStatistics() :
+  mLowerQuartile(0.25),
+  mMedian(0.5),
+  mUpperQuartile(0.75)
+{
+}
+
+/*!
+  Adds the sample \a value to the statistics. NaN values are ignored.
+*/
+void QCPBoxStatistics::addSample(double value)
+{
+  mLowerQuartile.addSample(value);
+  mMedian.addSample(value);
+  mUpperQuartile.addSample(value);
+}
+
+/*! \overload
+  
+  Adds \a count samples from the array \a values.
+*/
+void QCPBoxStatistics::addSamples(const double *values, int count)
+{
+  for (int i=0; i<count; ++i)
+    addSample(values[i]);
+}
+
+/*!
+  Removes all samples from the statistics.
+*/
+void QCPBoxStatistics::clear()
+{
+  mLowerQuartile.clear();
+  mMedian.clear();
+  mUpperQuartile.clear();
+}
+
+/*!
+  Sets the minimum, quartiles, median and maximum of \a box to the current estimates. The key and
+  the outliers of \a box are left unchanged. Does nothing if no samples were added.
+*/
+void QCPBoxStatistics::applyTo(QCPStatisticalBox *box) const
+{
+  if (!box) { qDebug() << Q_FUNC_INFO << "invalid box"; return; }
+  if (count() == 0)
+    return;
+  box->setMinimum(minimum());
+  box->setLowerQuartile(lowerQuartile());
+  box->setMedian(median());
+  box->setUpperQuartile(upperQuartile());
+  box->setMaximum(maximum());
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPColorMapData
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -20394,6 +23602,7 @@ void QCPColorMap::updateMapImage()
     else
       mMapImage = mUndersampledMapImage.scaled(valueSize*valueOversamplingFactor, keySize*keyOversamplingFactor, Qt::IgnoreAspectRatio, Qt::FastTransformation);
   }
+  mPreviewMapImage = QImage(); // regenerated from new mMapImage when needed
   mMapData->mDataModified = false;
   mMapImageInvalidated = false;
 }
@@ -20445,8 +23654,17 @@ void QCPColorMap::draw(QCPPainter *painter)
   imageRect.adjust(-halfCellWidth, -halfCellHeight, halfCellWidth, halfCellHeight);
   bool mirrorX = (keyAxis()->orientation() == Qt::Horizontal ? keyAxis() : valueAxis())->rangeReversed();
   bool mirrorY = (valueAxis()->orientation() == Qt::Vertical ? valueAxis() : keyAxis())->rangeReversed();
+  // in low resolution previews, use a half size image if the map image has more pixels than the screen area it covers:
+  const QImage *mapImage = &mMapImage;
+  bool lowResPreview = mParentPlot->previewSimplified(QCP::psLowResColorMap);
+  if (lowResPreview && mMapImage.width() > imageRect.width() && mMapImage.height() > imageRect.height() && mMapImage.width() > 1 && mMapImage.height() > 1)
+  {
+    if (mPreviewMapImage.isNull())
+      mPreviewMapImage = mMapImage.scaled(mMapImage.width()/2, mMapImage.height()/2, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+    mapImage = &mPreviewMapImage;
+  }
   bool smoothBackup = localPainter->renderHints().testFlag(QPainter::SmoothPixmapTransform);
-  localPainter->setRenderHint(QPainter::SmoothPixmapTransform, mInterpolate);
+  localPainter->setRenderHint(QPainter::SmoothPixmapTransform, mInterpolate && !lowResPreview);
   QRegion clipBackup;
   if (mTightBoundary)
   {
@@ -20455,7 +23673,7 @@ void QCPColorMap::draw(QCPPainter *painter)
                                   coordsToPixels(mMapData->keyRange().upper, mMapData->valueRange().upper)).normalized();
     localPainter->setClipRect(tightClipRect, Qt::IntersectClip);
   }
-  localPainter->drawImage(imageRect, mMapImage.mirrored(mirrorX, mirrorY));
+  localPainter->drawImage(imageRect, mapImage->mirrored(mirrorX, mirrorY));
   if (mTightBoundary)
     localPainter->setClipRegion(clipBackup);
   localPainter->setRenderHint(QPainter::SmoothPixmapTransform, smoothBackup);
@@ -20668,6 +23886,7 @@ QCPFinancial::~QCPFinancial()
 */
 void QCPFinancial::setData(QCPFinancialDataMap *data, bool copy)
 {
+  ++mDataVersion;
   if (mData == data)
   {
     qDebug() << Q_FUNC_INFO << "The data pointer is already in (and owned by) this plottable" << reinterpret_cast<quintptr>(data);
@@ -20692,6 +23911,7 @@ void QCPFinancial::setData(QCPFinancialDataMap *data, bool copy)
 */
 void QCPFinancial::setData(const QVector<double> &key, const QVector<double> &open, const QVector<double> &high, const QVector<double> &low, const QVector<double> &close)
 {
+  ++mDataVersion;
   mData->clear();
   int n = key.size();
   n = qMin(n, open.size());
@@ -20710,6 +23930,7 @@ void QCPFinancial::setData(const QVector<double> &key, const QVector<double> &op
 void QCPFinancial::setChartStyle(QCPFinancial::ChartStyle style)
 {
   mChartStyle = style;
+  mHitTestIndex.clear();
 }
 
 /*!
@@ -20720,6 +23941,7 @@ void QCPFinancial::setChartStyle(QCPFinancial::ChartStyle style)
 void QCPFinancial::setWidth(double width)
 {
   mWidth = width;
+  mHitTestIndex.clear();
 }
 
 /*!
@@ -20802,6 +24024,7 @@ void QCPFinancial::setPenNegative(const QPen &pen)
 */
 void QCPFinancial::addData(const QCPFinancialDataMap &dataMap)
 {
+  ++mDataVersion;
   mData->unite(dataMap);
 }
 
@@ -20816,6 +24039,7 @@ void QCPFinancial::addData(const QCPFinancialDataMap &dataMap)
 */
 void QCPFinancial::addData(const QCPFinancialData &data)
 {
+  ++mDataVersion;
   mData->insertMulti(data.key, data);
 }
 
@@ -20831,6 +24055,7 @@ void QCPFinancial::addData(const QCPFinancialData &data)
 */
 void QCPFinancial::addData(double key, double open, double high, double low, double close)
 {
+  ++mDataVersion;
   mData->insertMulti(key, QCPFinancialData(key, open, high, low, close));
 }
 
@@ -20845,6 +24070,7 @@ void QCPFinancial::addData(double key, double open, double high, double low, dou
 */
 void QCPFinancial::addData(const QVector<double> &key, const QVector<double> &open, const QVector<double> &high, const QVector<double> &low, const QVector<double> &close)
 {
+  ++mDataVersion;
   int n = key.size();
   n = qMin(n, open.size());
   n = qMin(n, high.size());
@@ -20863,6 +24089,7 @@ void QCPFinancial::addData(const QVector<double> &key, const QVector<double> &op
 */
 void QCPFinancial::removeDataBefore(double key)
 {
+  ++mDataVersion;
   QCPFinancialDataMap::iterator it = mData->begin();
   while (it != mData->end() && it.key() < key)
     it = mData->erase(it);
@@ -20875,6 +24102,7 @@ void QCPFinancial::removeDataBefore(double key)
 */
 void QCPFinancial::removeDataAfter(double key)
 {
+  ++mDataVersion;
   if (mData->isEmpty()) return;
   QCPFinancialDataMap::iterator it = mData->upperBound(key);
   while (it != mData->end())
@@ -20890,6 +24118,7 @@ void QCPFinancial::removeDataAfter(double key)
 */
 void QCPFinancial::removeData(double fromKey, double toKey)
 {
+  ++mDataVersion;
   if (fromKey >= toKey || mData->isEmpty()) return;
   QCPFinancialDataMap::iterator it = mData->upperBound(fromKey);
   QCPFinancialDataMap::iterator itEnd = mData->upperBound(toKey);
@@ -20907,6 +24136,7 @@ void QCPFinancial::removeData(double fromKey, double toKey)
 */
 void QCPFinancial::removeData(double key)
 {
+  ++mDataVersion;
   mData->remove(key);
 }
 
@@ -20917,6 +24147,7 @@ void QCPFinancial::removeData(double key)
 */
 void QCPFinancial::clearData()
 {
+  ++mDataVersion;
   mData->clear();
 }
 
@@ -20930,6 +24161,25 @@ double QCPFinancial::selectTest(const QPointF &pos, bool onlySelectable, QVarian
   
   if (mKeyAxis.data()->axisRect()->rect().contains(pos.toPoint()))
   {
+    // reuse the geometry of the last replot, if axes and data haven't changed since:
+    if (mHitTestIndex.isValid(hitTestStamp()))
+    {
+      double distance = mHitTestIndex.distance(pos);
+      if (mChartStyle == csCandlestick)
+      {
+        const double boxDistance = mParentPlot->selectionTolerance()*0.99;
+        for (int i=0; i<mHitTestBoxes.size(); ++i)
+        {
+          if (mHitTestBoxes.at(i).contains(pos)) // is in open-close-box
+          {
+            if (distance < 0 || boxDistance < distance)
+              distance = boxDistance;
+            break;
+          }
+        }
+      }
+      return distance;
+    }
     // get visible data range:
     QCPFinancialDataMap::const_iterator lower, upper; // note that upper is the actual upper point, and not 1 step after the upper point
     getVisibleDataBounds(lower, upper);
@@ -21002,19 +24252,37 @@ QCPFinancialDataMap QCPFinancial::timeSeriesToOhlc(const QVector<double> &time,
 /* inherits documentation from base class */
 void QCPFinancial::draw(QCPPainter *painter)
 {
+  mHitTestIndex.clear(); // replaced by the geometry drawn below
+  mHitTestBoxes.clear();
   // get visible data range:
   QCPFinancialDataMap::const_iterator lower, upper; // note that upper is the actual upper point, and not 1 step after the upper point
   getVisibleDataBounds(lower, upper);
   if (lower == mData->constEnd() || upper == mData->constEnd())
     return;
+  QCPFinancialDataMap::const_iterator drawBegin = lower;
+  QCPFinancialDataMap::const_iterator drawEnd = upper+1;
+  
+  // if the candles are narrower than a pixel column, merge the bins of each column into one:
+  QCPFinancialDataMap mergedData;
+  if (mKeyAxis)
+  {
+    const double columnWidth = mParentPlot->previewSimplified(QCP::psCoarseSampling) ? 4.0 : 1.0;
+    const double candleWidth = qAbs(mKeyAxis.data()->coordToPixel(lower.key()+mWidth*0.5)-mKeyAxis.data()->coordToPixel(lower.key()-mWidth*0.5));
+    if (candleWidth < columnWidth)
+    {
+      getMergedData(lower, upper+1, columnWidth, &mergedData);
+      drawBegin = mergedData.constBegin();
+      drawEnd = mergedData.constEnd();
+    }
+  }
   
   // draw visible data range according to configured style:
   switch (mChartStyle)
   {
     case QCPFinancial::csOhlc:
-      drawOhlcPlot(painter, lower, upper+1); break;
+      drawOhlcPlot(painter, drawBegin, drawEnd); break;
     case QCPFinancial::csCandlestick:
-      drawCandlestickPlot(painter, lower, upper+1); break;
+      drawCandlestickPlot(painter, drawBegin, drawEnd); break;
   }
 }
 
@@ -21158,11 +24426,55 @@ QCPRange QCPFinancial::getValueRange(bool &foundRange, QCPAbstractPlottable::Sig
   return range;
 }
 
+/*! \internal
+  
+  Merges the data from \a begin to \a end into \a mergedData, such that all consecutive bins whose
+  keys lie in the same pixel column of width \a columnWidth are combined into one bin: It has the
+  key and open value of the first bin, the close value of the last bin, and the extreme high and
+  low values of all bins in the column.
+  
+  This is used by \ref draw when the candles are narrower than a pixel, so views spanning many
+  bins only draw one candle per pixel column, which looks the same.
+*/
+void QCPFinancial::getMergedData(const QCPFinancialDataMap::const_iterator &begin, const QCPFinancialDataMap::const_iterator &end, double columnWidth, QCPFinancialDataMap *mergedData) const
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  if (!keyAxis) { qDebug() << Q_FUNC_INFO << "invalid key axis"; return; }
+  if (begin == end)
+    return;
+  
+  QCPFinancialData currentBin = begin.value();
+  int currentColumn = qFloor(keyAxis->coordToPixel(begin.key())/columnWidth);
+  for (QCPFinancialDataMap::const_iterator it = begin+1; it != end; ++it)
+  {
+    const int column = qFloor(keyAxis->coordToPixel(it.key())/columnWidth);
+    if (column == currentColumn) // bin in same column, extend merged bin:
+    {
+      if (it.value().high > currentBin.high) currentBin.high = it.value().high;
+      if (it.value().low < currentBin.low) currentBin.low = it.value().low;
+      currentBin.close = it.value().close;
+    } else // new column, finalize merged bin and start the next:
+    {
+#if QT_VERSION < QT_VERSION_CHECK(5, 1, 0)
+      mergedData->insert(currentBin.key, currentBin);
+#else
+      mergedData->insert(mergedData->constEnd(), currentBin.key, currentBin);
+#endif
+      currentBin = it.value();
+      currentColumn = column;
+    }
+  }
+  mergedData->insert(currentBin.key, currentBin);
+}
+
 /*! \internal
   
   Draws the data from \a begin to \a end as OHLC bars with the provided \a painter.
 
   This method is a helper function for \ref draw. It is used when the chart style is \ref csOhlc.
+  
+  The lines are collected per color, and each group is drawn with a single call, so the pen is only
+  changed once per group.
 */
 void QCPFinancial::drawOhlcPlot(QCPPainter *painter, const QCPFinancialDataMap::const_iterator &begin, const QCPFinancialDataMap::const_iterator &end)
 {
@@ -21170,53 +24482,62 @@ void QCPFinancial::drawOhlcPlot(QCPPainter *painter, const QCPFinancialDataMap::
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
   
-  QPen linePen;
+  QVector<QLineF> positiveLines, negativeLines; // lines are collected per pen and drawn with one call each. If not two colored, all go to positiveLines
+  QVector<QPointF> hitTestLines; // backbones, kept for selectTest
+  const bool splitColors = mTwoColored && !mSelected;
   
   if (keyAxis->orientation() == Qt::Horizontal)
   {
     for (QCPFinancialDataMap::const_iterator it = begin; it != end; ++it)
     {
-      if (mSelected)
-        linePen = mSelectedPen;
-      else if (mTwoColored)
-        linePen = it.value().close >= it.value().open ? mPenPositive : mPenNegative;
-      else
-        linePen = mPen;
-      painter->setPen(linePen);
+      QVector<QLineF> &lines = splitColors && it.value().close < it.value().open ? negativeLines : positiveLines;
       double keyPixel = keyAxis->coordToPixel(it.value().key);
       double openPixel = valueAxis->coordToPixel(it.value().open);
       double closePixel = valueAxis->coordToPixel(it.value().close);
-      // draw backbone:
-      painter->drawLine(QPointF(keyPixel, valueAxis->coordToPixel(it.value().high)), QPointF(keyPixel, valueAxis->coordToPixel(it.value().low)));
-      // draw open:
+      // backbone:
+      QPointF highPoint(keyPixel, valueAxis->coordToPixel(it.value().high));
+      QPointF lowPoint(keyPixel, valueAxis->coordToPixel(it.value().low));
+      lines.append(QLineF(highPoint, lowPoint));
+      hitTestLines << highPoint << lowPoint;
+      // open:
       double keyWidthPixels = keyPixel-keyAxis->coordToPixel(it.value().key-mWidth*0.5); // sign of this makes sure open/close are on correct sides
-      painter->drawLine(QPointF(keyPixel-keyWidthPixels, openPixel), QPointF(keyPixel, openPixel));
-      // draw close:
-      painter->drawLine(QPointF(keyPixel, closePixel), QPointF(keyPixel+keyWidthPixels, closePixel));
+      lines.append(QLineF(QPointF(keyPixel-keyWidthPixels, openPixel), QPointF(keyPixel, openPixel)));
+      // close:
+      lines.append(QLineF(QPointF(keyPixel, closePixel), QPointF(keyPixel+keyWidthPixels, closePixel)));
     }
   } else
   {
     for (QCPFinancialDataMap::const_iterator it = begin; it != end; ++it)
     {
-      if (mSelected)
-        linePen = mSelectedPen;
-      else if (mTwoColored)
-        linePen = it.value().close >= it.value().open ? mPenPositive : mPenNegative;
-      else
-        linePen = mPen;
-      painter->setPen(linePen);
+      QVector<QLineF> &lines = splitColors && it.value().close < it.value().open ? negativeLines : positiveLines;
       double keyPixel = keyAxis->coordToPixel(it.value().key);
       double openPixel = valueAxis->coordToPixel(it.value().open);
       double closePixel = valueAxis->coordToPixel(it.value().close);
-      // draw backbone:
-      painter->drawLine(QPointF(valueAxis->coordToPixel(it.value().high), keyPixel), QPointF(valueAxis->coordToPixel(it.value().low), keyPixel));
-      // draw open:
+      // backbone:
+      QPointF highPoint(valueAxis->coordToPixel(it.value().high), keyPixel);
+      QPointF lowPoint(valueAxis->coordToPixel(it.value().low), keyPixel);
+      lines.append(QLineF(highPoint, lowPoint));
+      hitTestLines << highPoint << lowPoint;
+      // open:
       double keyWidthPixels = keyPixel-keyAxis->coordToPixel(it.value().key-mWidth*0.5); // sign of this makes sure open/close are on correct sides
-      painter->drawLine(QPointF(openPixel, keyPixel-keyWidthPixels), QPointF(openPixel, keyPixel));
-      // draw close:
-      painter->drawLine(QPointF(closePixel, keyPixel), QPointF(closePixel, keyPixel+keyWidthPixels));
+      lines.append(QLineF(QPointF(openPixel, keyPixel-keyWidthPixels), QPointF(openPixel, keyPixel)));
+      // close:
+      lines.append(QLineF(QPointF(closePixel, keyPixel), QPointF(closePixel, keyPixel+keyWidthPixels)));
     }
   }
+  
+  // draw collected lines:
+  if (!positiveLines.isEmpty())
+  {
+    painter->setPen(mSelected ? mSelectedPen : (mTwoColored ? mPenPositive : mPen));
+    painter->drawLines(positiveLines);
+  }
+  if (!negativeLines.isEmpty())
+  {
+    painter->setPen(mPenNegative);
+    painter->drawLines(negativeLines);
+  }
+  mHitTestIndex.setPoints(hitTestLines, QCPSegmentIndexPrivate::gLinePairs, hitTestStamp());
 }
 
 /*! \internal
@@ -21224,6 +24545,9 @@ void QCPFinancial::drawOhlcPlot(QCPPainter *painter, const QCPFinancialDataMap::
   Draws the data from \a begin to \a end as Candlesticks with the provided \a painter.
 
   This method is a helper function for \ref draw. It is used when the chart style is \ref csCandlestick.
+  
+  The high/low lines and the open-close boxes are collected per color, and each group is drawn
+  with a single call, so pen and brush are only changed once per group.
 */
 void QCPFinancial::drawCandlestickPlot(QCPPainter *painter, const QCPFinancialDataMap::const_iterator &begin, const QCPFinancialDataMap::const_iterator &end)
 {
@@ -21231,84 +24555,69 @@ void QCPFinancial::drawCandlestickPlot(QCPPainter *painter, const QCPFinancialDa
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
   
-  QPen linePen;
-  QBrush boxBrush;
+  QVector<QLineF> positiveLines, negativeLines; // if not two colored, all lines and boxes go to the positive vectors
+  QVector<QRectF> positiveBoxes, negativeBoxes;
+  QVector<QPointF> hitTestLines; // high and low lines, kept for selectTest together with the boxes
+  const bool splitColors = mTwoColored && !mSelected;
   
   if (keyAxis->orientation() == Qt::Horizontal)
   {
     for (QCPFinancialDataMap::const_iterator it = begin; it != end; ++it)
     {
-      if (mSelected)
-      {
-        linePen = mSelectedPen;
-        boxBrush = mSelectedBrush;
-      } else if (mTwoColored)
-      {
-        if (it.value().close >= it.value().open)
-        {
-          linePen = mPenPositive;
-          boxBrush = mBrushPositive;
-        } else
-        {
-          linePen = mPenNegative;
-          boxBrush = mBrushNegative;
-        }
-      } else
-      {
-        linePen = mPen;
-        boxBrush = mBrush;
-      }
-      painter->setPen(linePen);
-      painter->setBrush(boxBrush);
+      const bool negative = splitColors && it.value().close < it.value().open;
       double keyPixel = keyAxis->coordToPixel(it.value().key);
       double openPixel = valueAxis->coordToPixel(it.value().open);
       double closePixel = valueAxis->coordToPixel(it.value().close);
-      // draw high:
-      painter->drawLine(QPointF(keyPixel, valueAxis->coordToPixel(it.value().high)), QPointF(keyPixel, valueAxis->coordToPixel(qMax(it.value().open, it.value().close))));
-      // draw low:
-      painter->drawLine(QPointF(keyPixel, valueAxis->coordToPixel(it.value().low)), QPointF(keyPixel, valueAxis->coordToPixel(qMin(it.value().open, it.value().close))));
-      // draw open-close box:
+      // high:
+      hitTestLines << QPointF(keyPixel, valueAxis->coordToPixel(it.value().high)) << QPointF(keyPixel, valueAxis->coordToPixel(qMax(it.value().open, it.value().close)));
+      (negative ? negativeLines : positiveLines).append(QLineF(hitTestLines.at(hitTestLines.size()-2), hitTestLines.last()));
+      // low:
+      hitTestLines << QPointF(keyPixel, valueAxis->coordToPixel(it.value().low)) << QPointF(keyPixel, valueAxis->coordToPixel(qMin(it.value().open, it.value().close)));
+      (negative ? negativeLines : positiveLines).append(QLineF(hitTestLines.at(hitTestLines.size()-2), hitTestLines.last()));
+      // open-close box:
       double keyWidthPixels = keyPixel-keyAxis->coordToPixel(it.value().key-mWidth*0.5);
-      painter->drawRect(QRectF(QPointF(keyPixel-keyWidthPixels, closePixel), QPointF(keyPixel+keyWidthPixels, openPixel)));
+      QRectF boxRect(QPointF(keyPixel-keyWidthPixels, closePixel), QPointF(keyPixel+keyWidthPixels, openPixel));
+      (negative ? negativeBoxes : positiveBoxes).append(boxRect);
+      mHitTestBoxes.append(boxRect.normalized());
     }
   } else // keyAxis->orientation() == Qt::Vertical
   {
     for (QCPFinancialDataMap::const_iterator it = begin; it != end; ++it)
     {
-      if (mSelected)
-      {
-        linePen = mSelectedPen;
-        boxBrush = mSelectedBrush;
-      } else if (mTwoColored)
-      {
-        if (it.value().close >= it.value().open)
-        {
-          linePen = mPenPositive;
-          boxBrush = mBrushPositive;
-        } else
-        {
-          linePen = mPenNegative;
-          boxBrush = mBrushNegative;
-        }
-      } else
-      {
-        linePen = mPen;
-        boxBrush = mBrush;
-      }
-      painter->setPen(linePen);
-      painter->setBrush(boxBrush);
+      const bool negative = splitColors && it.value().close < it.value().open;
       double keyPixel = keyAxis->coordToPixel(it.value().key);
       double openPixel = valueAxis->coordToPixel(it.value().open);
       double closePixel = valueAxis->coordToPixel(it.value().close);
-      // draw high:
-      painter->drawLine(QPointF(valueAxis->coordToPixel(it.value().high), keyPixel), QPointF(valueAxis->coordToPixel(qMax(it.value().open, it.value().close)), keyPixel));
-      // draw low:
-      painter->drawLine(QPointF(valueAxis->coordToPixel(it.value().low), keyPixel), QPointF(valueAxis->coordToPixel(qMin(it.value().open, it.value().close)), keyPixel));
-      // draw open-close box:
+      // high:
+      hitTestLines << QPointF(valueAxis->coordToPixel(it.value().high), keyPixel) << QPointF(valueAxis->coordToPixel(qMax(it.value().open, it.value().close)), keyPixel);
+      (negative ? negativeLines : positiveLines).append(QLineF(hitTestLines.at(hitTestLines.size()-2), hitTestLines.last()));
+      // low:
+      hitTestLines << QPointF(valueAxis->coordToPixel(it.value().low), keyPixel) << QPointF(valueAxis->coordToPixel(qMin(it.value().open, it.value().close)), keyPixel);
+      (negative ? negativeLines : positiveLines).append(QLineF(hitTestLines.at(hitTestLines.size()-2), hitTestLines.last()));
+      // open-close box:
       double keyWidthPixels = keyPixel-keyAxis->coordToPixel(it.value().key-mWidth*0.5);
-      painter->drawRect(QRectF(QPointF(closePixel, keyPixel-keyWidthPixels), QPointF(openPixel, keyPixel+keyWidthPixels)));
+      QRectF boxRect(QPointF(closePixel, keyPixel-keyWidthPixels), QPointF(openPixel, keyPixel+keyWidthPixels));
+      (negative ? negativeBoxes : positiveBoxes).append(boxRect);
+      mHitTestBoxes.append(boxRect.normalized());
     }
   }
+  
+  // draw collected lines and boxes:
+  if (!positiveBoxes.isEmpty())
+  {
+    painter->setPen(mSelected ? mSelectedPen : (mTwoColored ? mPenPositive : mPen));
+    painter->setBrush(mSelected ? mSelectedBrush : (mTwoColored ? mBrushPositive : mBrush));
+    painter->drawLines(positiveLines);
+    painter->drawRects(positiveBoxes);
+  }
+  if (!negativeBoxes.isEmpty())
+  {
+    painter->setPen(mPenNegative);
+    painter->setBrush(mBrushNegative);
+    painter->drawLines(negativeLines);
+    painter->drawRects(negativeBoxes);
+  }
+  mHitTestIndex.setPoints(hitTestLines, QCPSegmentIndexPrivate::gLinePairs, hitTestStamp());
 }
 
 /*! \internal
@@ -21450,6 +24759,164 @@ void QCPFinancial::getVisibleDataBounds(QCPFinancialDataMap::const_iterator &low
   upper = (highoutlier ? ubound : ubound-1); // data point range that will be actually drawn
 }
 
+/*! \internal
+  
+  Returns the state of the axes and data that determines the pixel geometry of the OHLC bars or
+  candlesticks. \ref selectTest reuses the geometry of the last replot as long as this stamp
+  doesn't change.
+*/
+QCPSegmentIndexPrivate::Stamp QCPFinancial::hitTestStamp() const
+{
+  QCPSegmentIndexPrivate::Stamp stamp;
+  stamp.axisRect = mKeyAxis.data()->axisRect()->rect();
+  stamp.keyRange = mKeyAxis.data()->range();
+  stamp.valueRange = mValueAxis.data()->range();
+  stamp.dataCount = mData->size();
+  stamp.dataVersion = mDataVersion;
+  return stamp;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPOhlcAggregator
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPOhlcAggregator
+  \brief Incrementally bins a stream of samples into OHLC data of a QCPFinancial
+  
+  While \ref QCPFinancial::timeSeriesToOhlc converts a complete time series at once,
+  QCPOhlcAggregator processes samples as they arrive. Each sample passed to \ref addSample either
+  extends the current bin (updating its high, low and close) or, if it belongs to a later bin,
+  starts a new one. The current bin is written to the data of the \ref financial plottable right
+  away, so the latest candle grows live, and closed bins are never processed again. Each sample
+  only updates the last entry of the data map, which costs logarithmic time in the number of bins.
+  
+  Bins are placed like in \ref QCPFinancial::timeSeriesToOhlc: a bin is centered at a key <tt>binOffset
+  + n*binSize</tt>, and spans half a bin size to either side. Bins without samples are skipped.
+  
+  To show several bin sizes at the same time, use one aggregator and one QCPFinancial per bin size,
+  and pass every sample to all aggregators:
+  \code
+  QCPOhlcAggregator seconds(financial1s, 1), tenSeconds(financial10s, 10), minutes(financial1min, 60);
+  // for every new sample:
+  seconds.addSample(time, value);
+  tenSeconds.addSample(time, value);
+  minutes.addSample(time, value);
+  \endcode
+  
+  With \ref setMaxBinCount, the oldest bins are removed from the financial plottable, so a long
+  running display uses bounded memory.
+*/
+
+/*!
+  Creates an aggregator that writes bins of size \a binSize into \a financial. \a binOffset defines
+  the phase of the bins, see \ref QCPFinancial::timeSeriesToOhlc.
+  
+  The aggregator doesn't take ownership of \a financial.
+*/
+QCPOhlcAggregator::QCPOhlcAggregator(QCPFinancial *financial, double binSize, double binOffset) :
+  mFinancial(financial),
+  mBinSize(binSize),
+  mBinOffset(binOffset),
+  mMaxBinCount(0),
+  mHasCurrentBin(false),
+  mCurrentBinIndex(0)
+{
+  if (mBinSize <= 0)
+  {
+    qDebug() << Q_FUNC_INFO << "bin size must be positive:" << binSize;
+    mBinSize = 1;
+  }
+}
+
+/*!
+  Sets the maximum number of bins kept in the data of the \ref financial plottable. When a new bin
+  is started and the data contains more bins, the oldest are removed. 0 means no limit, which is
+  the default.
+*/
+void QCPOhlcAggregator::setMaxBinCount(int count)
+{
+  mMaxBinCount = qMax(0, count);
+}
+
+/*!
+  Adds the sample \a value at \a time. Samples must be added in ascending order of \a time. A sample
+  that belongs to a bin before the current one is ignored, since that bin was already closed. NaN
+  and infinite times or values are ignored.
+*/
+void QCPOhlcAggregator::addSample(double time, double value)
+{
+  if (!qIsFinite(value) || !qIsFinite(time)) // infinite times would overflow the bin index
+    return;
+  const qint64 index = qint64(floor((time-mBinOffset)/mBinSize+0.5)); // do not use qFloor here, it returns int and epoch times with small bins exceed its range
+  if (mHasCurrentBin && index == mCurrentBinIndex) // sample extends current bin
+  {
+    if (value < mCurrentBin.low) mCurrentBin.low = value;
+    if (value > mCurrentBin.high) mCurrentBin.high = value;
+    mCurrentBin.close = value;
+  } else if (!mHasCurrentBin || index > mCurrentBinIndex) // sample starts a new bin, the current one stays in the data as is
+  {
+    mHasCurrentBin = true;
+    mCurrentBinIndex = index;
+    mCurrentBin = QCPFinancialData(mBinOffset+index*mBinSize, value, value, value, value);
+  } else
+  {
+    qDebug() << Q_FUNC_INFO << "sample belongs to an already closed bin:" << time;
+    return;
+  }
+  writeCurrentBin();
+}
+
+/*! \overload
+  
+  Adds \a count samples from the arrays \a times and \a values.
+*/
+void QCPOhlcAggregator::addSamples(const double *times, const double *values, int count)
+{
+  for (int i=0; i<count; ++i)
+    addSample(times[i], values[i]);
+}
+
+/*!
+  Forgets the current bin, so the next sample starts a new bin. The data of the \ref financial
+  plottable is left unchanged.
+*/
+void QCPOhlcAggregator::reset()
+{
+  mHasCurrentBin = false;
+}
+
+/*! \internal
+  
+  Writes the current bin to the data of the financial plottable. Since the current bin is the last
+  one, this replaces the last data point if it has the key of the current bin, and appends a new
+  data point otherwise. Applies the maximum bin count when a bin was appended.
+*/
+void QCPOhlcAggregator::writeCurrentBin()
+{
+  QCPFinancial *financial = mFinancial.data();
+  if (!financial)
+    return;
+  QCPFinancialDataMap *data = financial->mData;
+  ++financial->mDataVersion;
+  if (!data->isEmpty() && (data->end()-1).key() == mCurrentBin.key)
+  {
+    (data->end()-1).value() = mCurrentBin;
+  } else
+  {
+#if QT_VERSION < QT_VERSION_CHECK(5, 1, 0)
+    data->insert(mCurrentBin.key, mCurrentBin);
+#else
+    data->insert(data->constEnd(), mCurrentBin.key, mCurrentBin); // end hint avoids a full key lookup when appending
+#endif
+    if (mMaxBinCount > 0)
+    {
+      while (data->size() > mMaxBinCount)
+        data->erase(data->begin());
+    }
+  }
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPItemStraightLine
@@ -22975,6 +26442,13 @@ QPen QCPItemPixmap::mainPen() const
   positions to the tracer \a position (used as an anchor) via \ref
   QCPItemPosition::setParentAnchor.
   
+  To let a tracer follow the mouse cursor on large graphs, put it (and items attached to it, e.g. a
+  QCPItemText showing the value) on the hover layer of the plot, see \ref
+  QCustomPlot::setHoverLayer. In the mouse move handler, set the key with \ref setGraphKey and call
+  \ref QCustomPlot::replotHover. Then only the hover layer is redrawn, and the graph data point is
+  found with a binary search in the data map, so cursor tracking stays fast regardless of the
+  number of data points.
+  
   \note The tracer position is only automatically updated upon redraws. So when the data of the
   graph changes and immediately afterwards (without a redraw) the a position coordinates of the
   tracer are retrieved, they will not reflect the updated data of the graph. In this case \ref
@@ -43,6 +43,7 @@
 #include <QPaintEvent>
 #include <QMouseEvent>
 #include <QPixmap>
+#include <QImage>
 #include <QVector>
 #include <QString>
 #include <QDateTime>
@@ -53,6 +54,17 @@
 #include <QStack>
 #include <QCache>
 #include <QMargins>
+#include <QPicture>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QTimer>
+#if QT_VERSION < QT_VERSION_CHECK(4, 7, 0)
+#  include <QTime>
+#else
+#  include <QElapsedTimer>
+#endif
 #include <qmath.h>
 #include <limits>
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
@@ -72,6 +84,7 @@ class QCPLayout;
 class QCPAxis;
 class QCPAxisRect;
 class QCPAxisPainterPrivate;
+class QCPLabelAtlasPrivate;
 class QCPAbstractPlottable;
 class QCPGraph;
 class QCPAbstractItem;
@@ -83,6 +96,7 @@ class QCPAbstractLegendItem;
 class QCPColorMap;
 class QCPColorScale;
 class QCPBars;
+class QCPExportJob;
 
 
 /*! \file */
@@ -160,6 +174,10 @@ enum PlottingHint { phNone            = 0x000 ///< <tt>0x000</tt> No hints are s
                     ,phForceRepaint   = 0x002 ///< <tt>0x002</tt> causes an immediate repaint() instead of a soft update() when QCustomPlot::replot() is called with parameter \ref QCustomPlot::rpHint. /**< TODO: describe */
                                               ///<                This is set by default to prevent the plot from freezing on fast consecutive replots (e.g. user drags ranges with mouse).
                     ,phCacheLabels    = 0x004 ///< <tt>0x004</tt> axis (tick) labels will be cached as pixmaps, increasing replot performance.
+                    ,phCacheScatters  = 0x008 ///< <tt>0x008</tt> scatter symbols of graphs and curves will be pre-rendered to a sprite pixmap which is then blitted
+                                              ///<                for each data point, increasing replot performance for many scatters (see \ref QCPScatterStyle::drawShapes).
+                    ,phParallelCurves = 0x010 ///< <tt>0x010</tt> the clipping of curves with more than 100,000 points is distributed over the threads of the global QThreadPool
+                                              ///<                (see \ref QCPCurve). The generated curve is identical to the one of the single threaded clipping.
                   };
 /**
  * @brief 
@@ -189,6 +207,29 @@ enum Interaction { iRangeDrag         = 0x001 ///< <tt>0x001</tt> Axis ranges ar
  */
 Q_DECLARE_FLAGS(Interactions, Interaction)
 
+/*!
+  Defines the simplifications that are applied while the plot shows a reduced quality preview
+  during range dragging and zooming with the mouse.
+  
+  \c PreviewSimplifications is a flag of or-combined elements of this enum type.
+  
+  \see QCustomPlot::setPreviewSimplifications, QCustomPlot::setProgressiveRefinement
+*/
+enum PreviewSimplification { psNone              = 0x000 ///< <tt>0x000</tt> The preview is drawn in full quality
+                             ,psNoAntialiasing   = 0x001 ///< <tt>0x001</tt> All elements are drawn without antialiasing
+                             ,psCoarseSampling   = 0x002 ///< <tt>0x002</tt> Graphs and curves with adaptive sampling consolidate data over several pixels instead of one (see \ref QCPGraph::setAdaptiveSampling, \ref QCPCurve::setAdaptiveSampling), and QCPFinancial merges candles narrower than four pixels
+                             ,psNoScatters       = 0x004 ///< <tt>0x004</tt> Scatter symbols of graphs and curves, and outliers of statistical boxes are not drawn
+                             ,psLowResColorMap   = 0x008 ///< <tt>0x008</tt> Color maps are drawn from a lower resolution image and without interpolation
+                             ,psNoErrorBars      = 0x010 ///< <tt>0x010</tt> Error bars of graphs are not drawn
+                             ,psNoSubGrid        = 0x020 ///< <tt>0x020</tt> Sub grid lines are not drawn
+                             ,psAll              = 0xFFF ///< <tt>0xFFF</tt> All simplifications
+                           };
+/**
+ * @brief 
+ *
+ */
+Q_DECLARE_FLAGS(PreviewSimplifications, PreviewSimplification)
+
 /*! \internal
   
   Returns whether the specified \a value is considered an invalid data value for plottables (i.e.
@@ -255,6 +296,7 @@ Q_DECLARE_OPERATORS_FOR_FLAGS(QCP::AntialiasedElements)
 Q_DECLARE_OPERATORS_FOR_FLAGS(QCP::PlottingHints)
 Q_DECLARE_OPERATORS_FOR_FLAGS(QCP::MarginSides)
 Q_DECLARE_OPERATORS_FOR_FLAGS(QCP::Interactions)
+Q_DECLARE_OPERATORS_FOR_FLAGS(QCP::PreviewSimplifications)
 
 
 /**
@@ -458,6 +500,14 @@ public:
    * @param y
    */
   void drawShape(QCPPainter *painter, double x, double y) const;
+  /**
+   * @brief 
+   *
+   * @param painter
+   * @param positions
+   * @param useSprite
+   */
+  void drawShapes(QCPPainter *painter, const QVector<QPointF> &positions, bool useSprite=true) const;
 
 protected:
   // property members:
@@ -470,6 +520,26 @@ protected:
   
   // non-property members:
   bool mPenDefined; /**< TODO: describe */
+  mutable QPixmap mSprite; /**< TODO: describe */
+  mutable QPen mSpritePen; /**< TODO: describe */
+  mutable QBrush mSpriteBrush; /**< TODO: describe */
+  mutable bool mSpriteAntialiased; /**< TODO: describe */
+  mutable QPointF mSpriteOffset; /**< TODO: describe */
+  
+  // non-virtual methods:
+  /**
+   * @brief 
+   *
+   * @param painter
+   * @return bool
+   */
+  bool canUseSprite(const QCPPainter *painter) const;
+  /**
+   * @brief 
+   *
+   * @param painter
+   */
+  void updateSprite(const QCPPainter *painter) const;
 };
 Q_DECLARE_TYPEINFO(QCPScatterStyle, Q_MOVABLE_TYPE);
 
@@ -589,6 +659,13 @@ public:
    * @param p2
    */
   void drawLine(const QPointF &p1, const QPointF &p2) {drawLine(QLineF(p1, p2));}
+  /**
+   * @brief 
+   *
+   * @param lines
+   */
+  void drawLines(const QVector<QLineF> &lines);
+  using QPainter::drawLines; // keep the other QPainter overloads, e.g. for point pairs, visible
   /**
    * @brief 
    *
@@ -631,8 +708,19 @@ class QCP_LIB_DECL QCPLayer : public QObject
   Q_PROPERTY(int index READ index)
   Q_PROPERTY(QList<QCPLayerable*> children READ children)
   Q_PROPERTY(bool visible READ visible WRITE setVisible)
+  Q_PROPERTY(LayerMode mode READ mode WRITE setMode)
   /// \endcond
 public:
+  /*!
+    Defines how the layer is rendered.
+    
+    \see setMode
+  */
+  Q_ENUMS(LayerMode)
+  enum LayerMode { lmBuffered ///< The layer is drawn into the main paint buffer of the QCustomPlot, together with all other buffered layers
+                   ,lmOverlay ///< The layer is drawn into its own buffer, which is composited on top of the main paint buffer. It can be replotted independently, see \ref replot
+                 };
+  
   /**
    * @brief 
    *
@@ -677,6 +765,12 @@ public:
    * @return bool
    */
   bool visible() const { return mVisible; }
+  /**
+   * @brief 
+   *
+   * @return LayerMode
+   */
+  LayerMode mode() const { return mMode; }
   
   // setters:
   /**
@@ -685,6 +779,19 @@ public:
    * @param visible
    */
   void setVisible(bool visible);
+  /**
+   * @brief 
+   *
+   * @param mode
+   */
+  void setMode(LayerMode mode);
+  
+  // non-property methods:
+  /**
+   * @brief 
+   *
+   */
+  void replot();
   
 protected:
   // property members:
@@ -693,8 +800,17 @@ protected:
   int mIndex; /**< TODO: describe */
   QList<QCPLayerable*> mChildren; /**< TODO: describe */
   bool mVisible; /**< TODO: describe */
+  LayerMode mMode; /**< TODO: describe */
+  
+  // non-property members:
+  QPixmap mOverlayBuffer; /**< TODO: describe */
   
   // non-virtual methods:
+  /**
+   * @brief 
+   *
+   */
+  void drawOverlayBuffer();
   /**
    * @brief 
    *
@@ -720,6 +836,7 @@ private:
   friend class QCustomPlot;
   friend class QCPLayerable;
 };
+Q_DECLARE_METATYPE(QCPLayer::LayerMode)
 
 /**
  * @brief 
@@ -1299,6 +1416,7 @@ class QCP_LIB_DECL QCPLayoutElement : public QCPLayerable
   Q_PROPERTY(QRect outerRect READ outerRect WRITE setOuterRect)
   Q_PROPERTY(QMargins margins READ margins WRITE setMargins)
   Q_PROPERTY(QMargins minimumMargins READ minimumMargins WRITE setMinimumMargins)
+  Q_PROPERTY(int autoMarginShrinkDelay READ autoMarginShrinkDelay WRITE setAutoMarginShrinkDelay)
   Q_PROPERTY(QSize minimumSize READ minimumSize WRITE setMinimumSize)
   Q_PROPERTY(QSize maximumSize READ maximumSize WRITE setMaximumSize)
   /// \endcond
@@ -1362,6 +1480,12 @@ public:
    * @return QCP::MarginSides
    */
   QCP::MarginSides autoMargins() const { return mAutoMargins; }
+  /**
+   * @brief 
+   *
+   * @return int
+   */
+  int autoMarginShrinkDelay() const { return mAutoMarginShrinkDelay; }
   /**
    * @brief 
    *
@@ -1413,6 +1537,12 @@ public:
    * @param sides
    */
   void setAutoMargins(QCP::MarginSides sides);
+  /**
+   * @brief 
+   *
+   * @param replots
+   */
+  void setAutoMarginShrinkDelay(int replots);
   /**
    * @brief 
    *
@@ -1493,6 +1623,10 @@ protected:
   QMargins mMargins, mMinimumMargins; /**< TODO: describe */
   QCP::MarginSides mAutoMargins; /**< TODO: describe */
   QHash<QCP::MarginSide, QCPMarginGroup*> mMarginGroups; /**< TODO: describe */
+  int mAutoMarginShrinkDelay; /**< TODO: describe */
+  
+  // non-property members:
+  QHash<QCP::MarginSide, int> mMarginShrinkCounts; /**< TODO: describe */
   
   // introduced virtual methods:
   /**
@@ -3352,6 +3486,10 @@ protected:
   QVector<double> mSubTickVector; /**< TODO: describe */
   bool mCachedMarginValid; /**< TODO: describe */
   int mCachedMargin; /**< TODO: describe */
+  double mTickVectorStep; /**< TODO: describe */
+  qint64 mTickVectorFirstStep, mTickVectorLastStep; /**< TODO: describe */
+  QCache<qint64, QString> mDateTimeLabelCache; /**< TODO: describe */
+  QString mDateTimeLabelCacheKey; /**< TODO: describe */
   
   // introduced virtual methods:
   /**
@@ -3422,6 +3560,13 @@ protected:
    * @param highIndex
    */
   void visibleTickBounds(int &lowIndex, int &highIndex) const;
+  /**
+   * @brief 
+   *
+   * @param tick
+   * @return QString
+   */
+  QString dateTimeTickLabel(double tick);
   /**
    * @brief 
    *
@@ -3496,6 +3641,106 @@ Q_DECLARE_OPERATORS_FOR_FLAGS(QCPAxis::AxisTypes)
 Q_DECLARE_METATYPE(QCPAxis::SelectablePart)
 
 
+/**
+ * @brief 
+ *
+ */
+class QCPLabelAtlasPrivate
+{
+public:
+  /**
+   * @brief 
+   *
+   */
+  struct Label
+  {
+    QPixmap pixmap; /**< TODO: describe */
+    QRect totalBounds, rotatedTotalBounds; /**< TODO: describe */
+  };
+  /**
+   * @brief 
+   *
+   */
+  struct Glyph
+  {
+    QPixmap pixmap; /**< TODO: describe */
+    int offset; /**< TODO: describe */
+    double advance; /**< TODO: describe */
+  };
+  
+  /**
+   * @brief 
+   *
+   * @return QCPLabelAtlasPrivate
+   */
+  static QCPLabelAtlasPrivate *acquire();
+  /**
+   * @brief 
+   *
+   */
+  static void release();
+  
+  /**
+   * @brief 
+   *
+   * @param key
+   * @param label
+   * @return bool
+   */
+  bool findLabel(const QByteArray &key, Label *label);
+  /**
+   * @brief 
+   *
+   * @param key
+   * @param label
+   */
+  void insertLabel(const QByteArray &key, const Label &label);
+  /**
+   * @brief 
+   *
+   * @param fontKey
+   * @param font
+   * @param color
+   * @param character
+   * @return Glyph
+   */
+  Glyph glyph(const QByteArray &fontKey, const QFont &font, const QColor &color, QChar character);
+  /**
+   * @brief 
+   *
+   */
+  void clear();
+  /**
+   * @brief 
+   *
+   * @param metrics
+   * @param character
+   * @return double
+   */
+  static double glyphAdvance(const QFontMetricsF &metrics, QChar character);
+  
+protected:
+  QCache<QByteArray, Label> mLabels; /**< TODO: describe */
+  QCache<QByteArray, Glyph> mGlyphs; /**< TODO: describe */
+  static QCPLabelAtlasPrivate *mInstance; /**< TODO: describe */
+  static int mReferenceCount; /**< TODO: describe */
+  
+  /**
+   * @brief 
+   *
+   */
+  QCPLabelAtlasPrivate();
+  
+private:
+  /**
+   * @brief 
+   *
+   * @param 
+   */
+  Q_DISABLE_COPY(QCPLabelAtlasPrivate)
+};
+
+
 /**
  * @brief 
  *
@@ -3579,15 +3824,6 @@ public:
   QVector<QString> tickLabels; /**< TODO: describe */
   
 protected:
-  /**
-   * @brief 
-   *
-   */
-  struct CachedLabel
-  {
-    QPointF offset; /**< TODO: describe */
-    QPixmap pixmap; /**< TODO: describe */
-  };
   /**
    * @brief 
    *
@@ -3599,8 +3835,8 @@ protected:
     QFont baseFont, expFont; /**< TODO: describe */
   };
   QCustomPlot *mParentPlot; /**< TODO: describe */
-  QByteArray mLabelParameterHash; // to determine whether mLabelCache needs to be cleared due to changed parameters /**< TODO: describe */
-  QCache<QString, CachedLabel> mLabelCache; /**< TODO: describe */
+  mutable QByteArray mLabelParameterHash; // prefix of the keys of this axis' labels in the shared label atlas /**< TODO: describe */
+  QCPLabelAtlasPrivate *mLabelAtlas; /**< TODO: describe */
   QRect mAxisSelectionBox, mTickLabelsSelectionBox, mLabelSelectionBox; /**< TODO: describe */
   
   /**
@@ -3652,6 +3888,30 @@ protected:
    * @param tickLabelsSize
    */
   virtual void getMaxTickLabelSize(const QFont &font, const QString &text, QSize *tickLabelsSize) const;
+  /**
+   * @brief 
+   *
+   * @param painter
+   * @param text
+   * @return QCPLabelAtlasPrivate::Label
+   */
+  virtual QCPLabelAtlasPrivate::Label createCachedLabel(QCPPainter *painter, const QString &text) const;
+  /**
+   * @brief 
+   *
+   * @param text
+   * @return bool
+   */
+  bool canComposeTickLabel(const QString &text) const;
+  /**
+   * @brief 
+   *
+   * @param font
+   * @param text
+   * @param leftPadding
+   * @return QSize
+   */
+  QSize composedTickLabelSize(const QFont &font, const QString &text, int *leftPadding=0) const;
 };
 
 
@@ -3912,6 +4172,9 @@ protected:
   QPointer<QCPAxis> mKeyAxis, mValueAxis; /**< TODO: describe */
   bool mSelectable, mSelected; /**< TODO: describe */
   
+  // non-property members:
+  int mDataVersion; /**< TODO: describe */
+  
   // reimplemented virtual methods:
   /**
    * @brief 
@@ -4642,6 +4905,11 @@ class QCP_LIB_DECL QCustomPlot : public QWidget
   Q_PROPERTY(bool autoAddPlottableToLegend READ autoAddPlottableToLegend WRITE setAutoAddPlottableToLegend)
   Q_PROPERTY(int selectionTolerance READ selectionTolerance WRITE setSelectionTolerance)
   Q_PROPERTY(bool noAntialiasingOnDrag READ noAntialiasingOnDrag WRITE setNoAntialiasingOnDrag)
+  Q_PROPERTY(int queuedReplotInterval READ queuedReplotInterval WRITE setQueuedReplotInterval)
+  Q_PROPERTY(bool progressiveRefinement READ progressiveRefinement WRITE setProgressiveRefinement)
+  Q_PROPERTY(int refinementDelay READ refinementDelay WRITE setRefinementDelay)
+  Q_PROPERTY(bool layoutCaching READ layoutCaching WRITE setLayoutCaching)
+  Q_PROPERTY(QCP::PreviewSimplifications previewSimplifications READ previewSimplifications WRITE setPreviewSimplifications)
   Q_PROPERTY(Qt::KeyboardModifier multiSelectModifier READ multiSelectModifier WRITE setMultiSelectModifier)
   /// \endcond
 public:
@@ -4663,6 +4931,7 @@ public:
   enum RefreshPriority { rpImmediate ///< The QCustomPlot surface is immediately refreshed, by calling QWidget::repaint() after the replot
                          ,rpQueued   ///< Queues the refresh such that it is performed at a slightly delayed point in time after the replot, by calling QWidget::update() after the replot
                          ,rpHint     ///< Whether to use immediate repaint or queued update depends on whether the plotting hint \ref QCP::phForceRepaint is set, see \ref setPlottingHints.
+                         ,rpQueuedReplot ///< Queues the entire replot, see \ref setQueuedReplotInterval. Multiple queued replots are coalesced into one, which uses the state at the time it is performed.
                        };
   
   /**
@@ -4744,6 +5013,49 @@ public:
    * @return bool
    */
   bool noAntialiasingOnDrag() const { return mNoAntialiasingOnDrag; }
+  /**
+   * @brief 
+   *
+   * @return int
+   */
+  int queuedReplotInterval() const { return mQueuedReplotInterval; }
+  /**
+   * @brief 
+   *
+   * @return bool
+   */
+  bool progressiveRefinement() const { return mProgressiveRefinement; }
+  /**
+   * @brief 
+   *
+   * @return int
+   */
+  int refinementDelay() const { return mRefinementDelay; }
+  /**
+   * @brief 
+   *
+   * @return bool
+   */
+  bool layoutCaching() const { return mLayoutCaching; }
+  /**
+   * @brief 
+   *
+   * @return bool
+   */
+  bool interactionPreview() const { return mInteractionPreview; }
+  /**
+   * @brief 
+   *
+   * @return QCP::PreviewSimplifications
+   */
+  QCP::PreviewSimplifications previewSimplifications() const { return mPreviewSimplifications; }
+  /**
+   * @brief 
+   *
+   * @param simplification
+   * @return bool
+   */
+  bool previewSimplified(QCP::PreviewSimplification simplification) const { return mInteractionPreview && mPreviewSimplifications.testFlag(simplification); }
   /**
    * @brief 
    *
@@ -4853,6 +5165,30 @@ public:
    * @param enabled
    */
   void setNoAntialiasingOnDrag(bool enabled);
+  /**
+   * @brief 
+   *
+   * @param milliseconds
+   */
+  void setQueuedReplotInterval(int milliseconds);
+  /**
+   * @brief 
+   *
+   * @param enabled
+   */
+  void setProgressiveRefinement(bool enabled);
+  /**
+   * @brief 
+   *
+   * @param milliseconds
+   */
+  void setRefinementDelay(int milliseconds);
+  /**
+   * @brief 
+   *
+   * @param enabled
+   */
+  void setLayoutCaching(bool enabled);
   /**
    * @brief 
    *
@@ -4866,6 +5202,19 @@ public:
    * @param enabled
    */
   void setPlottingHint(QCP::PlottingHint hint, bool enabled=true);
+  /**
+   * @brief 
+   *
+   * @param simplifications
+   */
+  void setPreviewSimplifications(const QCP::PreviewSimplifications &simplifications);
+  /**
+   * @brief 
+   *
+   * @param simplification
+   * @param enabled
+   */
+  void setPreviewSimplification(QCP::PreviewSimplification simplification, bool enabled=true);
   /**
    * @brief 
    *
@@ -5088,6 +5437,12 @@ public:
    * @return QCPLayer
    */
   QCPLayer *currentLayer() const;
+  /**
+   * @brief 
+   *
+   * @return QCPLayer
+   */
+  QCPLayer *hoverLayer() const { return mHoverLayer; }
   /**
    * @brief 
    *
@@ -5102,6 +5457,13 @@ public:
    * @return bool
    */
   bool setCurrentLayer(QCPLayer *layer);
+  /**
+   * @brief 
+   *
+   * @param layer
+   * @return bool
+   */
+  bool setHoverLayer(QCPLayer *layer);
   /**
    * @brief 
    *
@@ -5262,13 +5624,64 @@ public:
   /**
    * @brief 
    *
-   * @param refreshPriority
-   */
-  Q_SLOT void replot(QCustomPlot::RefreshPriority refreshPriority=QCustomPlot::rpHint);
-  
-  QCPAxis *xAxis, *yAxis, *xAxis2, *yAxis2; /**< TODO: describe */
-  QCPLegend *legend; /**< TODO: describe */
-  
+   * @param fileName
+   * @param noCosmeticPen
+   * @param width
+   * @param height
+   * @param pdfCreator
+   * @param pdfTitle
+   * @return bool
+   */
+  bool savePdfAsync(const QString &fileName, bool noCosmeticPen=false, int width=0, int height=0, const QString &pdfCreator=QString(), const QString &pdfTitle=QString());
+  /**
+   * @brief 
+   *
+   * @param fileName
+   * @param width
+   * @param height
+   * @param scale
+   * @param quality
+   * @return bool
+   */
+  bool savePngAsync(const QString &fileName, int width=0, int height=0, double scale=1.0, int quality=-1);
+  /**
+   * @brief 
+   *
+   * @param fileName
+   * @param width
+   * @param height
+   * @param scale
+   * @param format
+   * @param quality
+   * @return bool
+   */
+  bool saveRasteredAsync(const QString &fileName, int width, int height, double scale, const char *format, int quality=-1);
+  /**
+   * @brief 
+   *
+   * @return int
+   */
+  int pendingExportCount() const { return mExportJobs.size(); }
+  /**
+   * @brief 
+   *
+   * @param refreshPriority
+   */
+  Q_SLOT void replot(QCustomPlot::RefreshPriority refreshPriority=QCustomPlot::rpHint);
+  /**
+   * @brief 
+   *
+   */
+  Q_SLOT void replotHover();
+  /**
+   * @brief 
+   *
+   */
+  void invalidateLayout() { mLayoutValid = false; }
+  
+  QCPAxis *xAxis, *yAxis, *xAxis2, *yAxis2; /**< TODO: describe */
+  QCPLegend *legend; /**< TODO: describe */
+  
 signals:
   /**
    * @brief 
@@ -5391,6 +5804,13 @@ signals:
    *
    */
   void afterReplot();
+  /**
+   * @brief 
+   *
+   * @param fileName
+   * @param success
+   */
+  void exportFinished(const QString &fileName, bool success);
   
 protected:
   // property members:
@@ -5405,12 +5825,18 @@ protected:
   QCP::Interactions mInteractions; /**< TODO: describe */
   int mSelectionTolerance; /**< TODO: describe */
   bool mNoAntialiasingOnDrag; /**< TODO: describe */
+  int mQueuedReplotInterval; /**< TODO: describe */
+  bool mProgressiveRefinement; /**< TODO: describe */
+  int mRefinementDelay; /**< TODO: describe */
+  bool mLayoutCaching; /**< TODO: describe */
+  QCP::PreviewSimplifications mPreviewSimplifications; /**< TODO: describe */
   QBrush mBackgroundBrush; /**< TODO: describe */
   QPixmap mBackgroundPixmap; /**< TODO: describe */
   QPixmap mScaledBackgroundPixmap; /**< TODO: describe */
   bool mBackgroundScaled; /**< TODO: describe */
   Qt::AspectRatioMode mBackgroundScaledMode; /**< TODO: describe */
   QCPLayer *mCurrentLayer; /**< TODO: describe */
+  QCPLayer *mHoverLayer; /**< TODO: describe */
   QCP::PlottingHints mPlottingHints; /**< TODO: describe */
   Qt::KeyboardModifier mMultiSelectModifier; /**< TODO: describe */
   
@@ -5419,6 +5845,16 @@ protected:
   QPoint mMousePressPos; /**< TODO: describe */
   QPointer<QCPLayoutElement> mMouseEventElement; /**< TODO: describe */
   bool mReplotting; /**< TODO: describe */
+  bool mLayoutValid; /**< TODO: describe */
+  QList<QCPExportJob*> mExportJobs; /**< TODO: describe */
+  QTimer *mQueuedReplotTimer; /**< TODO: describe */
+  QTimer *mRefinementTimer; /**< TODO: describe */
+#if QT_VERSION < QT_VERSION_CHECK(4, 7, 0)
+  QTime mLastReplotTime; /**< TODO: describe */
+#else
+  QElapsedTimer mLastReplotTime; /**< TODO: describe */
+#endif
+  bool mInteractionPreview; /**< TODO: describe */
   
   // reimplemented virtual methods:
   /**
@@ -5517,6 +5953,47 @@ protected:
    * @param painter
    */
   void drawBackground(QCPPainter *painter);
+  /**
+   * @brief 
+   *
+   * @param painter
+   * @param layer
+   */
+  void drawLayer(QCPPainter *painter, QCPLayer *layer);
+  /**
+   * @brief 
+   *
+   * @param picture
+   * @param width
+   * @param height
+   * @param modes
+   * @param background
+   * @return bool
+   */
+  bool recordPicture(QPicture *picture, int width, int height, const QCPPainter::PainterModes &modes, const QBrush &background);
+  /**
+   * @brief 
+   *
+   * @param job
+   */
+  void startExportJob(QCPExportJob *job);
+  /**
+   * @brief 
+   *
+   * @param fileName
+   * @param success
+   */
+  Q_SLOT void exportJobFinished(const QString &fileName, bool success);
+  /**
+   * @brief 
+   *
+   */
+  void interactionReplot();
+  /**
+   * @brief 
+   *
+   */
+  Q_SLOT void refineReplot();
   
   friend class QCPLegend;
   friend class QCPAxis;
@@ -5525,6 +6002,130 @@ protected:
 };
 
 
+/**
+ * @brief 
+ *
+ */
+class QCP_LIB_DECL QCPExportJob : public QThread
+{
+  Q_OBJECT
+public:
+  /*!
+    Defines the kind of file an export job writes.
+    
+    \see setRasteredOutput, setPdfOutput
+  */
+  enum OutputType { otRastered ///< A rastered image file in any format supported by QImageWriter
+                    ,otPdf     ///< A vectorized PDF file
+                  };
+  
+  /**
+   * @brief 
+   *
+   * @param picture
+   * @param size
+   * @param fileName
+   * @param parent
+   */
+  QCPExportJob(const QPicture &picture, const QSize &size, const QString &fileName, QObject *parent=0);
+  /**
+   * @brief 
+   *
+   */
+  virtual ~QCPExportJob();
+  
+  // getters:
+  /**
+   * @brief 
+   *
+   * @return QString
+   */
+  QString fileName() const { return mFileName; }
+  /**
+   * @brief 
+   *
+   * @return QSize
+   */
+  QSize size() const { return mSize; }
+  /**
+   * @brief 
+   *
+   * @return OutputType
+   */
+  OutputType outputType() const { return mOutputType; }
+  
+  // setters:
+  /**
+   * @brief 
+   *
+   * @param format
+   * @param scale
+   * @param quality
+   * @param fillColor
+   */
+  void setRasteredOutput(const char *format, double scale, int quality, const QColor &fillColor);
+  /**
+   * @brief 
+   *
+   * @param pdfCreator
+   * @param pdfTitle
+   * @param resolution
+   */
+  void setPdfOutput(const QString &pdfCreator, const QString &pdfTitle, int resolution);
+  
+signals:
+  /**
+   * @brief 
+   *
+   * @param fileName
+   * @param success
+   */
+  void exportFinished(const QString &fileName, bool success);
+  
+protected:
+  // property members:
+  QPicture mPicture; /**< TODO: describe */
+  QSize mSize; /**< TODO: describe */
+  QString mFileName; /**< TODO: describe */
+  OutputType mOutputType; /**< TODO: describe */
+  QByteArray mFormat; /**< TODO: describe */
+  double mScale; /**< TODO: describe */
+  int mQuality; /**< TODO: describe */
+  QColor mFillColor; /**< TODO: describe */
+  QString mPdfCreator, mPdfTitle; /**< TODO: describe */
+  int mPdfResolution; /**< TODO: describe */
+  
+  // reimplemented virtual methods:
+  /**
+   * @brief 
+   *
+   */
+  virtual void run();
+  
+  // non-virtual methods:
+  /**
+   * @brief 
+   *
+   * @return bool
+   */
+  bool writeRastered();
+  /**
+   * @brief 
+   *
+   * @return bool
+   */
+  bool writePdf();
+  
+private:
+  /**
+   * @brief 
+   *
+   * @param 
+   */
+  Q_DISABLE_COPY(QCPExportJob)
+};
+
+
 /**
  * @brief 
  *
@@ -7335,100 +7936,362 @@ typedef QMutableMapIterator<double, QCPData> QCPDataMutableMapIterator;
  * @brief 
  *
  */
-class QCP_LIB_DECL QCPGraph : public QCPAbstractPlottable
+class QCPSegmentIndexPrivate
 {
-  Q_OBJECT
-  /// \cond INCLUDE_QPROPERTIES
-  Q_PROPERTY(LineStyle lineStyle READ lineStyle WRITE setLineStyle)
-  Q_PROPERTY(QCPScatterStyle scatterStyle READ scatterStyle WRITE setScatterStyle)
-  Q_PROPERTY(ErrorType errorType READ errorType WRITE setErrorType)
-  Q_PROPERTY(QPen errorPen READ errorPen WRITE setErrorPen)
-  Q_PROPERTY(double errorBarSize READ errorBarSize WRITE setErrorBarSize)
-  Q_PROPERTY(bool errorBarSkipSymbol READ errorBarSkipSymbol WRITE setErrorBarSkipSymbol)
-  Q_PROPERTY(QCPGraph* channelFillGraph READ channelFillGraph WRITE setChannelFillGraph)
-  Q_PROPERTY(bool adaptiveSampling READ adaptiveSampling WRITE setAdaptiveSampling)
-  /// \endcond
 public:
-  /*!
-    Defines how the graph's line is represented visually in the plot. The line is drawn with the
-    current pen of the graph (\ref setPen).
-    \see setLineStyle
-  */
-  enum LineStyle { lsNone        ///< data points are not connected with any lines (e.g. data only represented
-                                 ///< with symbols according to the scatter style, see \ref setScatterStyle)
-                   ,lsLine       ///< data points are connected by a straight line
-                   ,lsStepLeft   ///< line is drawn as steps where the step height is the value of the left data point
-                   ,lsStepRight  ///< line is drawn as steps where the step height is the value of the right data point
-                   ,lsStepCenter ///< line is drawn as steps where the step is in between two data points
-                   ,lsImpulse    ///< each data point is represented by a line parallel to the value axis, which reaches from the data point to the zero-value-line
-                 };
-  Q_ENUMS(LineStyle)
-  /*!
-    Defines what kind of error bars are drawn for each data point
-  */
-  enum ErrorType { etNone   ///< No error bars are shown
-                   ,etKey   ///< Error bars for the key dimension of the data point are shown
-                   ,etValue ///< Error bars for the value dimension of the data point are shown
-                   ,etBoth  ///< Error bars for both key and value dimensions of the data point are shown
-                 };
-  Q_ENUMS(ErrorType)
+  /**
+   * @brief 
+   *
+   */
+  enum Geometry { gPoints     ///< Each point is an item
+                  ,gPolyline  ///< Each pair of consecutive points forms a line segment
+                  ,gLinePairs ///< Points are pairwise connected (first and second, third and fourth, etc.)
+                };
   
   /**
    * @brief 
    *
-   * @param keyAxis
-   * @param valueAxis
    */
-  explicit QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis);
+  struct Stamp
+  {
+    /**
+     * @brief 
+     *
+     */
+    Stamp() : dataCount(-1), dataVersion(-1) {}
+    QRect axisRect; /**< TODO: describe */
+    QCPRange keyRange, valueRange; /**< TODO: describe */
+    int dataCount, dataVersion; /**< TODO: describe */
+    /**
+     * @brief 
+     *
+     * @param other
+     * @return bool operator
+     */
+    bool operator==(const Stamp &other) const { return axisRect == other.axisRect && keyRange == other.keyRange && valueRange == other.valueRange && dataCount == other.dataCount && dataVersion == other.dataVersion; }
+  };
+  
   /**
    * @brief 
    *
    */
-  virtual ~QCPGraph();
+  QCPSegmentIndexPrivate();
   
-  // getters:
+  // non-virtual methods:
   /**
    * @brief 
    *
-   * @return QCPDataMap
+   * @param points
+   * @param geometry
+   * @param stamp
    */
-  QCPDataMap *data() const { return mData; }
+  void setPoints(const QVector<QPointF> &points, Geometry geometry, const Stamp &stamp);
   /**
    * @brief 
    *
-   * @return LineStyle
    */
-  LineStyle lineStyle() const { return mLineStyle; }
+  void clear();
   /**
    * @brief 
    *
-   * @return QCPScatterStyle
+   * @param stamp
+   * @return bool
    */
-  QCPScatterStyle scatterStyle() const { return mScatterStyle; }
+  bool isValid(const Stamp &stamp) const { return mValid && mStamp == stamp; }
   /**
    * @brief 
    *
-   * @return ErrorType
+   * @param pos
+   * @return double
    */
-  ErrorType errorType() const { return mErrorType; }
+  double distance(const QPointF &pos);
+  
+protected:
+  // non-property members:
+  QVector<QPointF> mPoints; /**< TODO: describe */
+  Geometry mGeometry; /**< TODO: describe */
+  Stamp mStamp; /**< TODO: describe */
+  bool mValid, mGridBuilt; /**< TODO: describe */
+  int mCellSize, mColumns, mRows; /**< TODO: describe */
+  QVector<int> mCellStart, mCellItems; /**< TODO: describe */
+  
+  // non-virtual methods:
   /**
    * @brief 
    *
-   * @return QPen
    */
-  QPen errorPen() const { return mErrorPen; }
+  void buildGrid();
   /**
    * @brief 
    *
-   * @return double
+   * @return int
    */
-  double errorBarSize() const { return mErrorBarSize; }
+  int itemCount() const;
   /**
    * @brief 
    *
+   * @param item
+   * @param cellLeft
+   * @param cellTop
+   * @param cellRight
+   * @param cellBottom
    * @return bool
    */
-  bool errorBarSkipSymbol() const { return mErrorBarSkipSymbol; }
+  bool itemCells(int item, int &cellLeft, int &cellTop, int &cellRight, int &cellBottom) const;
+  /**
+   * @brief 
+   *
+   * @param item
+   * @param pos
+   * @return double
+   */
+  double itemDistSqr(int item, const QPointF &pos) const;
+  /**
+   * @brief 
+   *
+   * @param coord
+   * @param origin
+   * @param cellCount
+   * @return int
+   */
+  int cellIndex(double coord, int origin, int cellCount) const;
+};
+
+
+/**
+ * @brief 
+ *
+ */
+class QCP_LIB_DECL QCPCompactDataSeries
+{
+public:
+  /*!
+    Defines how keys and values are stored, see \ref QCPCompactDataSeries.
+  */
+  enum StorageMode { smDouble     ///< Keys and values are stored as double (16 bytes per point)
+                     ,smFloat     ///< Keys are stored as float offsets from a double base key, values as float (8 bytes per point)
+                     ,smQuantized ///< Keys are stored as 32 bit integer multiples of the key resolution from a base key, values as 16 bit integer multiples of the value resolution (6 bytes per point)
+                   };
+  
+  /**
+   * @brief 
+   *
+   * @param mode
+   * @param keyResolution
+   * @param valueResolution
+   */
+  explicit QCPCompactDataSeries(StorageMode mode=smFloat, double keyResolution=1.0, double valueResolution=1.0);
+  
+  // getters:
+  /**
+   * @brief 
+   *
+   * @return StorageMode
+   */
+  StorageMode mode() const { return mMode; }
+  /**
+   * @brief 
+   *
+   * @return double
+   */
+  double keyResolution() const { return mKeyResolution; }
+  /**
+   * @brief 
+   *
+   * @return double
+   */
+  double valueResolution() const { return mValueResolution; }
+  
+  // non-property methods:
+  /**
+   * @brief 
+   *
+   * @return int
+   */
+  int size() const;
+  /**
+   * @brief 
+   *
+   * @return bool
+   */
+  bool isEmpty() const { return size() == 0; }
+  /**
+   * @brief 
+   *
+   * @param index
+   * @return double
+   */
+  double key(int index) const;
+  /**
+   * @brief 
+   *
+   * @param index
+   * @return double
+   */
+  double value(int index) const;
+  /**
+   * @brief 
+   *
+   * @param key
+   * @param value
+   */
+  void append(double key, double value);
+  /**
+   * @brief 
+   *
+   * @param keys
+   * @param values
+   * @param count
+   */
+  void append(const double *keys, const double *values, int count);
+  /**
+   * @brief 
+   *
+   * @param count
+   */
+  void removeFirst(int count);
+  /**
+   * @brief 
+   *
+   */
+  void clear();
+  /**
+   * @brief 
+   *
+   * @param key
+   * @return int
+   */
+  int findBegin(double key) const;
+  /**
+   * @brief 
+   *
+   * @param graph
+   * @param lowerKey
+   * @param upperKey
+   */
+  void setGraphData(QCPGraph *graph, double lowerKey, double upperKey) const;
+  /**
+   * @brief 
+   *
+   * @return qint64
+   */
+  qint64 memoryUsage() const;
+  
+protected:
+  // property members:
+  StorageMode mMode; /**< TODO: describe */
+  double mKeyResolution, mValueResolution; /**< TODO: describe */
+  
+  // non-property members:
+  double mBaseKey; /**< TODO: describe */
+  int mFirst; /**< TODO: describe */
+  QVector<double> mDoubleKeys, mDoubleValues; /**< TODO: describe */
+  QVector<float> mFloatKeys, mFloatValues; /**< TODO: describe */
+  QVector<qint32> mIntKeys; /**< TODO: describe */
+  QVector<qint16> mIntValues; /**< TODO: describe */
+};
+
+/**
+ * @brief 
+ *
+ */
+class QCP_LIB_DECL QCPGraph : public QCPAbstractPlottable
+{
+  Q_OBJECT
+  /// \cond INCLUDE_QPROPERTIES
+  Q_PROPERTY(LineStyle lineStyle READ lineStyle WRITE setLineStyle)
+  Q_PROPERTY(QCPScatterStyle scatterStyle READ scatterStyle WRITE setScatterStyle)
+  Q_PROPERTY(ErrorType errorType READ errorType WRITE setErrorType)
+  Q_PROPERTY(QPen errorPen READ errorPen WRITE setErrorPen)
+  Q_PROPERTY(double errorBarSize READ errorBarSize WRITE setErrorBarSize)
+  Q_PROPERTY(bool errorBarSkipSymbol READ errorBarSkipSymbol WRITE setErrorBarSkipSymbol)
+  Q_PROPERTY(QCPGraph* channelFillGraph READ channelFillGraph WRITE setChannelFillGraph)
+  Q_PROPERTY(bool adaptiveSampling READ adaptiveSampling WRITE setAdaptiveSampling)
+  Q_PROPERTY(bool fastLineRendering READ fastLineRendering WRITE setFastLineRendering)
+  Q_PROPERTY(int maxDataCount READ maxDataCount WRITE setMaxDataCount)
+  Q_PROPERTY(double maxKeySpan READ maxKeySpan WRITE setMaxKeySpan)
+  /// \endcond
+public:
+  /*!
+    Defines how the graph's line is represented visually in the plot. The line is drawn with the
+    current pen of the graph (\ref setPen).
+    \see setLineStyle
+  */
+  enum LineStyle { lsNone        ///< data points are not connected with any lines (e.g. data only represented
+                                 ///< with symbols according to the scatter style, see \ref setScatterStyle)
+                   ,lsLine       ///< data points are connected by a straight line
+                   ,lsStepLeft   ///< line is drawn as steps where the step height is the value of the left data point
+                   ,lsStepRight  ///< line is drawn as steps where the step height is the value of the right data point
+                   ,lsStepCenter ///< line is drawn as steps where the step is in between two data points
+                   ,lsImpulse    ///< each data point is represented by a line parallel to the value axis, which reaches from the data point to the zero-value-line
+                 };
+  Q_ENUMS(LineStyle)
+  /*!
+    Defines what kind of error bars are drawn for each data point
+  */
+  enum ErrorType { etNone   ///< No error bars are shown
+                   ,etKey   ///< Error bars for the key dimension of the data point are shown
+                   ,etValue ///< Error bars for the value dimension of the data point are shown
+                   ,etBoth  ///< Error bars for both key and value dimensions of the data point are shown
+                 };
+  Q_ENUMS(ErrorType)
+  
+  /**
+   * @brief 
+   *
+   * @param keyAxis
+   * @param valueAxis
+   */
+  explicit QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis);
+  /**
+   * @brief 
+   *
+   */
+  virtual ~QCPGraph();
+  
+  // getters:
+  /**
+   * @brief 
+   *
+   * @return QCPDataMap
+   */
+  QCPDataMap *data() const { return mData; }
+  /**
+   * @brief 
+   *
+   * @return LineStyle
+   */
+  LineStyle lineStyle() const { return mLineStyle; }
+  /**
+   * @brief 
+   *
+   * @return QCPScatterStyle
+   */
+  QCPScatterStyle scatterStyle() const { return mScatterStyle; }
+  /**
+   * @brief 
+   *
+   * @return ErrorType
+   */
+  ErrorType errorType() const { return mErrorType; }
+  /**
+   * @brief 
+   *
+   * @return QPen
+   */
+  QPen errorPen() const { return mErrorPen; }
+  /**
+   * @brief 
+   *
+   * @return double
+   */
+  double errorBarSize() const { return mErrorBarSize; }
+  /**
+   * @brief 
+   *
+   * @return bool
+   */
+  bool errorBarSkipSymbol() const { return mErrorBarSkipSymbol; }
   /**
    * @brief 
    *
@@ -7441,6 +8304,24 @@ public:
    * @return bool
    */
   bool adaptiveSampling() const { return mAdaptiveSampling; }
+  /**
+   * @brief 
+   *
+   * @return bool
+   */
+  bool fastLineRendering() const { return mFastLineRendering; }
+  /**
+   * @brief 
+   *
+   * @return int
+   */
+  int maxDataCount() const { return mMaxDataCount; }
+  /**
+   * @brief 
+   *
+   * @return double
+   */
+  double maxKeySpan() const { return mMaxKeySpan; }
   
   // setters:
   /**
@@ -7450,6 +8331,14 @@ public:
    * @param copy
    */
   void setData(QCPDataMap *data, bool copy=false);
+#ifdef Q_COMPILER_RVALUE_REFS
+  /**
+   * @brief 
+   *
+   * @param data
+   */
+  void setData(QCPDataMap &&data);
+#endif
   /**
    * @brief 
    *
@@ -7457,6 +8346,14 @@ public:
    * @param value
    */
   void setData(const QVector<double> &key, const QVector<double> &value);
+  /**
+   * @brief 
+   *
+   * @param keys
+   * @param values
+   * @param count
+   */
+  void setData(const double *keys, const double *values, int count);
   /**
    * @brief 
    *
@@ -7559,6 +8456,24 @@ public:
    * @param enabled
    */
   void setAdaptiveSampling(bool enabled);
+  /**
+   * @brief 
+   *
+   * @param enabled
+   */
+  void setFastLineRendering(bool enabled);
+  /**
+   * @brief 
+   *
+   * @param count
+   */
+  void setMaxDataCount(int count);
+  /**
+   * @brief 
+   *
+   * @param span
+   */
+  void setMaxKeySpan(double span);
   
   // non-property methods:
   /**
@@ -7587,6 +8502,14 @@ public:
    * @param values
    */
   void addData(const QVector<double> &keys, const QVector<double> &values);
+  /**
+   * @brief 
+   *
+   * @param keys
+   * @param values
+   * @param count
+   */
+  void addData(const double *keys, const double *values, int count);
   /**
    * @brief 
    *
@@ -7664,6 +8587,13 @@ protected:
   bool mErrorBarSkipSymbol; /**< TODO: describe */
   QPointer<QCPGraph> mChannelFillGraph; /**< TODO: describe */
   bool mAdaptiveSampling; /**< TODO: describe */
+  bool mFastLineRendering; /**< TODO: describe */
+  int mMaxDataCount; /**< TODO: describe */
+  double mMaxKeySpan; /**< TODO: describe */
+  
+  // non-property members:
+  mutable QImage mLineRasterBuffer; /**< TODO: describe */
+  mutable QCPSegmentIndexPrivate mHitTestIndex; /**< TODO: describe */
   
   // reimplemented virtual methods:
   /**
@@ -7857,46 +8787,114 @@ protected:
    * @param lineData
    * @return const QPolygonF
    */
-  const QPolygonF getChannelFillPolygon(const QVector<QPointF> *lineData) const;
+  const QPolygonF getChannelFillPolygon(const QVector<QPointF> *lineData) const;
+  /**
+   * @brief 
+   *
+   * @param data
+   * @param x
+   * @return int
+   */
+  int findIndexBelowX(const QVector<QPointF> *data, double x) const;
+  /**
+   * @brief 
+   *
+   * @param data
+   * @param x
+   * @return int
+   */
+  int findIndexAboveX(const QVector<QPointF> *data, double x) const;
+  /**
+   * @brief 
+   *
+   * @param data
+   * @param y
+   * @return int
+   */
+  int findIndexBelowY(const QVector<QPointF> *data, double y) const;
+  /**
+   * @brief 
+   *
+   * @param data
+   * @param y
+   * @return int
+   */
+  int findIndexAboveY(const QVector<QPointF> *data, double y) const;
+  /**
+   * @brief 
+   *
+   * @param pixelPoint
+   * @return double
+   */
+  double pointDistance(const QPointF &pixelPoint) const;
+  /**
+   * @brief 
+   *
+   */
+  void applyRetention();
+  /**
+   * @brief 
+   *
+   * @param map
+   * @param keys
+   * @param values
+   * @param count
+   */
+  static void appendToDataMap(QCPDataMap *map, const double *keys, const double *values, int count);
+  /**
+   * @brief 
+   *
+   * @return QCPSegmentIndexPrivate::Stamp
+   */
+  QCPSegmentIndexPrivate::Stamp hitTestStamp() const;
+  /**
+   * @brief 
+   *
+   * @param painter
+   * @return bool
+   */
+  bool canRasterizeLinePlot(const QCPPainter *painter) const;
   /**
    * @brief 
    *
-   * @param data
-   * @param x
-   * @return int
+   * @param painter
+   * @param lineData
    */
-  int findIndexBelowX(const QVector<QPointF> *data, double x) const;
+  void rasterizeLinePlot(QCPPainter *painter, const QVector<QPointF> *lineData) const;
   /**
    * @brief 
    *
-   * @param data
-   * @param x
-   * @return int
+   * @param start
+   * @param end
+   * @param rect
+   * @return bool
    */
-  int findIndexAboveX(const QVector<QPointF> *data, double x) const;
+  bool clipLineToRect(QPointF &start, QPointF &end, const QRectF &rect) const;
   /**
    * @brief 
    *
-   * @param data
-   * @param y
-   * @return int
+   * @param painter
+   * @return bool
    */
-  int findIndexBelowY(const QVector<QPointF> *data, double y) const;
+  bool canSpanFill(const QCPPainter *painter) const;
   /**
    * @brief 
    *
-   * @param data
-   * @param y
-   * @return int
+   * @param painter
+   * @param lineData
    */
-  int findIndexAboveY(const QVector<QPointF> *data, double y) const;
+  void drawSpanFill(QCPPainter *painter, const QVector<QPointF> *lineData) const;
   /**
    * @brief 
    *
-   * @param pixelPoint
-   * @return double
+   * @param lineData
+   * @param firstColumn
+   * @param columnCount
+   * @param keyIsX
+   * @param shift
+   * @return QVector<double>
    */
-  double pointDistance(const QPointF &pixelPoint) const;
+  QVector<double> sampleFillColumns(const QVector<QPointF> *lineData, int firstColumn, int columnCount, bool keyIsX, const QPointF &shift) const;
   
   friend class QCustomPlot;
   friend class QCPLegend;
@@ -7948,6 +8946,43 @@ typedef QMapIterator<double, QCPCurveData> QCPCurveDataMapIterator;
 typedef QMutableMapIterator<double, QCPCurveData> QCPCurveDataMutableMapIterator;
 
 
+/**
+ * @brief 
+ *
+ */
+class QCPCurveClipJobPrivate : public QRunnable
+{
+public:
+  /**
+   * @brief 
+   *
+   * @param curve
+   * @param begin
+   * @param end
+   * @param rectLeft
+   * @param rectTop
+   * @param rectRight
+   * @param rectBottom
+   * @param finished
+   */
+  QCPCurveClipJobPrivate(const QCPCurve *curve, QCPCurveDataMap::const_iterator begin, QCPCurveDataMap::const_iterator end, double rectLeft, double rectTop, double rectRight, double rectBottom, QSemaphore *finished);
+  
+  /**
+   * @brief 
+   *
+   */
+  virtual void run();
+  
+  QVector<QPointF> lineData; /**< TODO: describe */
+  
+protected:
+  const QCPCurve *mCurve; /**< TODO: describe */
+  QCPCurveDataMap::const_iterator mBegin, mEnd; /**< TODO: describe */
+  double mRectLeft, mRectTop, mRectRight, mRectBottom; /**< TODO: describe */
+  QSemaphore *mFinished; /**< TODO: describe */
+};
+
+
 /**
  * @brief 
  *
@@ -7958,6 +8993,7 @@ class QCP_LIB_DECL QCPCurve : public QCPAbstractPlottable
   /// \cond INCLUDE_QPROPERTIES
   Q_PROPERTY(QCPScatterStyle scatterStyle READ scatterStyle WRITE setScatterStyle)
   Q_PROPERTY(LineStyle lineStyle READ lineStyle WRITE setLineStyle)
+  Q_PROPERTY(bool adaptiveSampling READ adaptiveSampling WRITE setAdaptiveSampling)
   /// \endcond
 public:
   /*!
@@ -8000,6 +9036,12 @@ public:
    * @return LineStyle
    */
   LineStyle lineStyle() const { return mLineStyle; }
+  /**
+   * @brief 
+   *
+   * @return bool
+   */
+  bool adaptiveSampling() const { return mAdaptiveSampling; }
   
   // setters:
   /**
@@ -8036,6 +9078,12 @@ public:
    * @param style
    */
   void setLineStyle(LineStyle style);
+  /**
+   * @brief 
+   *
+   * @param enabled
+   */
+  void setAdaptiveSampling(bool enabled);
   
   // non-property methods:
   /**
@@ -8120,6 +9168,10 @@ protected:
   QCPCurveDataMap *mData; /**< TODO: describe */
   QCPScatterStyle mScatterStyle; /**< TODO: describe */
   LineStyle mLineStyle; /**< TODO: describe */
+  bool mAdaptiveSampling; /**< TODO: describe */
+  
+  // non-property members:
+  mutable QCPSegmentIndexPrivate mHitTestIndex; /**< TODO: describe */
   
   // reimplemented virtual methods:
   /**
@@ -8168,6 +9220,12 @@ protected:
    * @param lineData
    */
   void getCurveData(QVector<QPointF> *lineData) const;
+  /**
+   * @brief 
+   *
+   * @param lineData
+   */
+  void decimateCurveData(QVector<QPointF> *lineData) const;
   /**
    * @brief 
    *
@@ -8255,9 +9313,16 @@ protected:
    * @return double
    */
   double pointDistance(const QPointF &pixelPoint) const;
+  /**
+   * @brief 
+   *
+   * @return QCPSegmentIndexPrivate::Stamp
+   */
+  QCPSegmentIndexPrivate::Stamp hitTestStamp() const;
   
   friend class QCustomPlot;
   friend class QCPLegend;
+  friend class QCPCurveClipJobPrivate;
 };
 
 
@@ -8728,38 +9793,265 @@ protected:
   /**
    * @brief 
    *
-   * @param key
-   * @param value
-   * @return QPolygonF
+   * @param key
+   * @param value
+   * @return QPolygonF
+   */
+  QPolygonF getBarPolygon(double key, double value) const;
+  /**
+   * @brief 
+   *
+   * @param key
+   * @param value
+   * @param base
+   * @return QPolygonF
+   */
+  QPolygonF getBarPolygon(double key, double value, double base) const;
+  /**
+   * @brief 
+   *
+   * @param key
+   * @param lower
+   * @param upper
+   */
+  void getPixelWidth(double key, double &lower, double &upper) const;
+  /**
+   * @brief 
+   *
+   * @param key
+   * @param positive
+   * @return double
+   */
+  double getStackedBaseValue(double key, bool positive) const;
+  /**
+   * @brief 
+   *
+   * @param keys
+   * @param positiveBases
+   * @param negativeBases
+   */
+  void getStackedBaseValues(const QVector<double> &keys, QVector<double> &positiveBases, QVector<double> &negativeBases) const;
+  /**
+   * @brief 
+   *
+   * @param lower
+   * @param upper
+   */
+  static void connectBars(QCPBars* lower, QCPBars* upper);
+  
+  friend class QCustomPlot;
+  friend class QCPLegend;
+  friend class QCPBarsGroup;
+};
+
+
+/**
+ * @brief 
+ *
+ */
+class QCP_LIB_DECL QCPHistogram
+{
+public:
+  /*!
+    Defines how the value range of the histogram is divided into bins.
+  */
+  enum BinScale { bsLinear        ///< All bins have the same width
+                  ,bsLogarithmic  ///< All bins have the same width on a logarithmic scale, i.e. the ratio of bin upper and lower bound is constant. The lower bound of the histogram must be positive.
+                };
+  /*!
+    Defines how long a sample contributes to the bin counts.
+  */
+  enum CountMode { cmCumulative  ///< Every sample is counted forever
+                   ,cmWindowed   ///< Only the most recent samples are counted, see \ref setWindowSize
+                   ,cmDecaying   ///< Every sample counts with a weight that decays exponentially with the number of newer samples, see \ref setDecayFactor
+                 };
+  
+  /**
+   * @brief 
+   *
+   * @param lower
+   * @param upper
+   * @param binCount
+   * @param scale
+   */
+  QCPHistogram(double lower, double upper, int binCount, BinScale scale=bsLinear);
+  
+  // getters:
+  /**
+   * @brief 
+   *
+   * @return double
+   */
+  double lower() const { return mLower; }
+  /**
+   * @brief 
+   *
+   * @return double
+   */
+  double upper() const { return mUpper; }
+  /**
+   * @brief 
+   *
+   * @return int
+   */
+  int binCount() const { return mBinCount; }
+  /**
+   * @brief 
+   *
+   * @return BinScale
+   */
+  BinScale binScale() const { return mBinScale; }
+  /**
+   * @brief 
+   *
+   * @return CountMode
+   */
+  CountMode countMode() const { return mCountMode; }
+  /**
+   * @brief 
+   *
+   * @return int
+   */
+  int windowSize() const { return mWindowSize; }
+  /**
+   * @brief 
+   *
+   * @return double
+   */
+  double decayFactor() const { return mDecayFactor; }
+  /**
+   * @brief 
+   *
+   * @return QCPBars
+   */
+  QCPBars *bars() const { return mBars.data(); }
+  
+  // setters:
+  /**
+   * @brief 
+   *
+   * @param mode
+   */
+  void setCountMode(CountMode mode);
+  /**
+   * @brief 
+   *
+   * @param sampleCount
+   */
+  void setWindowSize(int sampleCount);
+  /**
+   * @brief 
+   *
+   * @param factor
+   */
+  void setDecayFactor(double factor);
+  /**
+   * @brief 
+   *
+   * @param bars
+   */
+  void setBars(QCPBars *bars);
+  
+  // non-property methods:
+  /**
+   * @brief 
+   *
+   * @param value
+   */
+  void addSample(double value);
+  /**
+   * @brief 
+   *
+   * @param values
+   * @param count
+   */
+  void addSamples(const double *values, int count);
+  /**
+   * @brief 
+   *
+   */
+  void clear();
+  /**
+   * @brief 
+   *
+   * @param value
+   * @return int
+   */
+  int binIndex(double value) const;
+  /**
+   * @brief 
+   *
+   * @param bin
+   * @return double
+   */
+  double binLower(int bin) const;
+  /**
+   * @brief 
+   *
+   * @param bin
+   * @return double
+   */
+  double binUpper(int bin) const;
+  /**
+   * @brief 
+   *
+   * @param bin
+   * @return double
+   */
+  double binCenter(int bin) const;
+  /**
+   * @brief 
+   *
+   * @param bin
+   * @return double
    */
-  QPolygonF getBarPolygon(double key, double value) const;
+  double count(int bin) const;
   /**
    * @brief 
    *
-   * @param key
-   * @param lower
-   * @param upper
+   * @return double
    */
-  void getPixelWidth(double key, double &lower, double &upper) const;
+  double underflowCount() const { return count(-1); }
   /**
    * @brief 
    *
-   * @param key
-   * @param positive
    * @return double
    */
-  double getStackedBaseValue(double key, bool positive) const;
+  double overflowCount() const { return count(mBinCount); }
   /**
    * @brief 
    *
-   * @param lower
-   * @param upper
    */
-  static void connectBars(QCPBars* lower, QCPBars* upper);
+  void updateBars();
   
-  friend class QCustomPlot;
-  friend class QCPLegend;
-  friend class QCPBarsGroup;
+protected:
+  // property members:
+  double mLower, mUpper; /**< TODO: describe */
+  int mBinCount; /**< TODO: describe */
+  BinScale mBinScale; /**< TODO: describe */
+  CountMode mCountMode; /**< TODO: describe */
+  int mWindowSize; /**< TODO: describe */
+  double mDecayFactor; /**< TODO: describe */
+  QPointer<QCPBars> mBars; /**< TODO: describe */
+  
+  // non-property members:
+  double mScaledLower, mBinsPerUnit; /**< TODO: describe */
+  QVector<double> mCounts; /**< TODO: describe */
+  double mSampleWeight; /**< TODO: describe */
+  QVector<int> mWindow; /**< TODO: describe */
+  int mWindowPosition, mWindowFill; /**< TODO: describe */
+  QVector<int> mChangedBins; /**< TODO: describe */
+  QVector<bool> mBinChanged; /**< TODO: describe */
+  bool mAllBinsChanged; /**< TODO: describe */
+  
+  // non-virtual methods:
+  /**
+   * @brief 
+   *
+   * @param slot
+   * @param weight
+   */
+  void addToSlot(int slot, double weight);
 };
 
 
@@ -9057,6 +10349,176 @@ protected:
 };
 
 
+/**
+ * @brief 
+ *
+ */
+class QCP_LIB_DECL QCPQuantileEstimator
+{
+public:
+  /**
+   * @brief 
+   *
+   * @param quantile
+   */
+  explicit QCPQuantileEstimator(double quantile=0.5);
+  
+  // getters:
+  /**
+   * @brief 
+   *
+   * @return double
+   */
+  double quantile() const { return mQuantile; }
+  
+  // non-property methods:
+  /**
+   * @brief 
+   *
+   * @param value
+   */
+  void addSample(double value);
+  /**
+   * @brief 
+   *
+   */
+  void clear();
+  /**
+   * @brief 
+   *
+   * @return qint64
+   */
+  qint64 count() const { return mCount; }
+  /**
+   * @brief 
+   *
+   * @return double
+   */
+  double estimate() const;
+  /**
+   * @brief 
+   *
+   * @return double
+   */
+  double minimum() const;
+  /**
+   * @brief 
+   *
+   * @return double
+   */
+  double maximum() const;
+  
+protected:
+  // property members:
+  double mQuantile; /**< TODO: describe */
+  
+  // non-property members:
+  qint64 mCount; /**< TODO: describe */
+  double mHeights[5]; /**< TODO: describe */
+  double mPositions[5]; /**< TODO: describe */
+  double mDesiredPositions[5]; /**< TODO: describe */
+  double mIncrements[5]; /**< TODO: describe */
+  
+  // non-virtual methods:
+  /**
+   * @brief 
+   *
+   * @param i
+   * @param d
+   * @return double
+   */
+  double parabolicHeight(int i, double d) const;
+  /**
+   * @brief 
+   *
+   * @param i
+   * @param d
+   * @return double
+   */
+  double linearHeight(int i, int d) const;
+};
+
+
+/**
+ * @brief 
+ *
+ */
+class QCP_LIB_DECL QCPBoxStatistics
+{
+public:
+  /**
+   * @brief 
+   *
+   */
+  QCPBoxStatistics();
+  
+  // non-property methods:
+  /**
+   * @brief 
+   *
+   * @param value
+   */
+  void addSample(double value);
+  /**
+   * @brief 
+   *
+   * @param values
+   * @param count
+   */
+  void addSamples(const double *values, int count);
+  /**
+   * @brief 
+   *
+   */
+  void clear();
+  /**
+   * @brief 
+   *
+   * @return qint64
+   */
+  qint64 count() const { return mMedian.count(); }
+  /**
+   * @brief 
+   *
+   * @return double
+   */
+  double minimum() const { return mMedian.minimum(); }
+  /**
+   * @brief 
+   *
+   * @return double
+   */
+  double lowerQuartile() const { return mLowerQuartile.estimate(); }
+  /**
+   * @brief 
+   *
+   * @return double
+   */
+  double median() const { return mMedian.estimate(); }
+  /**
+   * @brief 
+   *
+   * @return double
+   */
+  double upperQuartile() const { return mUpperQuartile.estimate(); }
+  /**
+   * @brief 
+   *
+   * @return double
+   */
+  double maximum() const { return mMedian.maximum(); }
+  /**
+   * @brief 
+   *
+   * @param box
+   */
+  void applyTo(QCPStatisticalBox *box) const;
+  
+protected:
+  QCPQuantileEstimator mLowerQuartile, mMedian, mUpperQuartile; /**< TODO: describe */
+};
+
+
 /**
  * @brief 
  *
@@ -9432,6 +10894,7 @@ protected:
   QPointer<QCPColorScale> mColorScale; /**< TODO: describe */
   // non-property members:
   QImage mMapImage, mUndersampledMapImage; /**< TODO: describe */
+  QImage mPreviewMapImage; /**< TODO: describe */
   QPixmap mLegendIcon; /**< TODO: describe */
   bool mMapImageInvalidated; /**< TODO: describe */
   
@@ -9768,6 +11231,10 @@ protected:
   QBrush mBrushPositive, mBrushNegative; /**< TODO: describe */
   QPen mPenPositive, mPenNegative; /**< TODO: describe */
   
+  // non-property members:
+  mutable QCPSegmentIndexPrivate mHitTestIndex; /**< TODO: describe */
+  QVector<QRectF> mHitTestBoxes; /**< TODO: describe */
+  
   // reimplemented virtual methods:
   /**
    * @brief 
@@ -9841,9 +11308,129 @@ protected:
    * @param upper
    */
   void getVisibleDataBounds(QCPFinancialDataMap::const_iterator &lower, QCPFinancialDataMap::const_iterator &upper) const;
+  /**
+   * @brief 
+   *
+   * @param begin
+   * @param end
+   * @param columnWidth
+   * @param mergedData
+   */
+  void getMergedData(const QCPFinancialDataMap::const_iterator &begin, const QCPFinancialDataMap::const_iterator &end, double columnWidth, QCPFinancialDataMap *mergedData) const;
+  /**
+   * @brief 
+   *
+   * @return QCPSegmentIndexPrivate::Stamp
+   */
+  QCPSegmentIndexPrivate::Stamp hitTestStamp() const;
   
   friend class QCustomPlot;
   friend class QCPLegend;
+  friend class QCPOhlcAggregator;
+};
+
+
+/**
+ * @brief 
+ *
+ */
+class QCP_LIB_DECL QCPOhlcAggregator
+{
+public:
+  /**
+   * @brief 
+   *
+   * @param financial
+   * @param binSize
+   * @param binOffset
+   */
+  QCPOhlcAggregator(QCPFinancial *financial, double binSize, double binOffset=0);
+  
+  // getters:
+  /**
+   * @brief 
+   *
+   * @return QCPFinancial
+   */
+  QCPFinancial *financial() const { return mFinancial.data(); }
+  /**
+   * @brief 
+   *
+   * @return double
+   */
+  double binSize() const { return mBinSize; }
+  /**
+   * @brief 
+   *
+   * @return double
+   */
+  double binOffset() const { return mBinOffset; }
+  /**
+   * @brief 
+   *
+   * @return int
+   */
+  int maxBinCount() const { return mMaxBinCount; }
+  
+  // setters:
+  /**
+   * @brief 
+   *
+   * @param count
+   */
+  void setMaxBinCount(int count);
+  
+  // non-property methods:
+  /**
+   * @brief 
+   *
+   * @param time
+   * @param value
+   */
+  void addSample(double time, double value);
+  /**
+   * @brief 
+   *
+   * @param times
+   * @param values
+   * @param count
+   */
+  void addSamples(const double *times, const double *values, int count);
+  /**
+   * @brief 
+   *
+   * @return bool
+   */
+  bool hasCurrentBin() const { return mHasCurrentBin; }
+  /**
+   * @brief 
+   *
+   * @return QCPFinancialData
+   */
+  QCPFinancialData currentBin() const { return mCurrentBin; }
+  /**
+   * @brief 
+   *
+   */
+  void reset();
+  
+protected:
+  // property members:
+  QPointer<QCPFinancial> mFinancial; /**< TODO: describe */
+  double mBinSize, mBinOffset; /**< TODO: describe */
+  int mMaxBinCount; /**< TODO: describe */
+  
+  // non-property members:
+  bool mHasCurrentBin; /**< TODO: describe */
+  qint64 mCurrentBinIndex; /**< TODO: describe */
+  QCPFinancialData mCurrentBin; /**< TODO: describe */
+  
+  // non-virtual methods:
+  /**
+   * @brief 
+   *
+   */
+  void writeCurrentBin();
 };
 
 